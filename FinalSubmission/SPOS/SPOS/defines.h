@@ -34,19 +34,29 @@
 //! The current id of the exercise (this must be changed every two weeks).
 #define VERSUCH 5
 
+/*!
+ *  Measures the kernel latencies with Timer 1 (see os_measure.h) if set to 1.
+ *  Timer 1 is not available to programs then.
+ */
+#define OS_MEASURE 0
+
 //----------------------------------------------------------------------------
 // System constants
 //----------------------------------------------------------------------------
 
 /*!
  *  Maximum number of processes that can be running at the same time
- *  (may be nothing > 8).
+ *  (may be nothing > 32, the width of a ProcessMask). More than 8 processes
+ *  need every heap in the byte-wide map format, as the nibble map only has
+ *  room for the owners 1-7. The kernel tables grow by GLOBALS_SIZE_PER_PROCESS
+ *  bytes per process, so the 4 KiB of the ATmega644 hold at most 18 processes
+ *  (see HEAPBOTTOM), more fail to compile.
  *  This number includes the idle proc, although it is considered a system proc.
  *  The idle proc. has always id 0. The highest ID is MAX_NUMBER_OF_PROCESSES-1.
  */
 #define MAX_NUMBER_OF_PROCESSES     8
 
-//! Maximum number of programs that can be known by the os (<17, 255 is invalid).
+//! Maximum number of programs that can be known by the os (multiple of 16, <65, 255 is invalid).
 #define MAX_NUMBER_OF_PROGRAMS      16
 
 //! Standard priority for newly created processes
@@ -55,6 +65,30 @@
 //! Default delay to read display values (in ms)
 #define DEFAULT_OUTPUT_DELAY        100
 
+//! Time ENTER and ESC have to be held down together to open the task manager (in ms)
+#define HOTKEY_DEBOUNCE_MS          20
+
+/*!
+ *  Map format of the internal heap (OS_MAP_NIBBLE or OS_MAP_BYTE, see MapFormat).
+ *  The nibble map leaves more of the small internal SRAM to the programs.
+ */
+#define INT_HEAP_MAP_FORMAT         OS_MAP_NIBBLE
+
+//! Map format of the external heap, its 64 KiB can afford the byte map
+#define EXT_HEAP_MAP_FORMAT         OS_MAP_BYTE
+
+//! Number of entries of the deferred work queue (power of two, <129)
+#define DEFERRED_QUEUE_SIZE         8
+
+//! Maximum number of deferred procedures run after every scheduling decision
+#define DEFERRED_BUDGET             4
+
+//! Number of shared memory chunks a process can hold open with priority inheritance
+#define SYNC_HELD_CHUNKS            2
+
+//! Number of jobs the worker pool queue holds (<256)
+#define WORKPOOL_QUEUE_SIZE         8
+
 //----------------------------------------------------------------------------
 // Scheduler constants
 //----------------------------------------------------------------------------
@@ -65,6 +99,27 @@
 //! Number to specify an invalid program.
 #define INVALID_PROGRAM             255
 
+/*!
+ *  Pass distance of a process with a single ticket in the stride strategy.
+ *  Passes are compared with wrap-around, so this has to stay below 2^15.
+ */
+#define STRIDE_ONE                  (1u << 14)
+
+//! Scheduling decisions after which the MLFQ moves every process back to the highest level (0 disables it)
+#define MLFQ_BOOST_INTERVAL         100
+
+//! Period of the scheduler tick after boot (in us, see os_setTickPeriod)
+#define SCHEDULER_TICK_US           3000
+
+//! Shortest tick period os_setTickPeriod accepts (in us), shorter ones leave no time for the processes
+#define SCHEDULER_TICK_MIN_US       200
+
+//! Number of ticks a process runs before the strategy is asked again (see os_setStrategyQuantum)
+#define SCHEDULER_QUANTUM           1
+
+//! Compare value of the scheduler timer (prescaler 1024) while only the idle process is runnable (~13 ms, the maximum)
+#define SCHEDULER_IDLE_COMPARE      255
+
 //----------------------------------------------------------------------------
 // Stack constants
 //----------------------------------------------------------------------------
@@ -75,8 +130,28 @@
 //! The scheduler's stack size
 #define STACK_SIZE_ISR              192
 
-//! The stack size of a process
-#define STACK_SIZE_PROC             (((AVR_MEMORY_SRAM / 2) - STACK_SIZE_MAIN - STACK_SIZE_ISR) / MAX_NUMBER_OF_PROCESSES)
+//! The stack size of the idle process
+#define STACK_SIZE_IDLE             64
+
+//! The stack size of a process whose program does not request one (the idle process gets STACK_SIZE_IDLE)
+#define STACK_SIZE_PROC             (((AVR_MEMORY_SRAM / 2) - STACK_SIZE_MAIN - STACK_SIZE_ISR - STACK_SIZE_IDLE) / (MAX_NUMBER_OF_PROCESSES - 1))
+
+//! The smallest stack a process gets (initial context, canary and a few calls)
+#define STACK_SIZE_MIN              48
+
+#if STACK_SIZE_PROC < STACK_SIZE_MIN
+    #error "Too many processes: STACK_SIZE_PROC is below STACK_SIZE_MIN"
+#endif
+
+/*!
+ *  The size of the region all process stacks are carved from.
+ *  Lower this once the high-water marks show how much the programs need,
+ *  everything below the region belongs to the internal heap.
+ */
+#define STACK_REGION_SIZE           (STACK_SIZE_IDLE + STACK_SIZE_PROC * (MAX_NUMBER_OF_PROCESSES - 1))
+
+//! Value unused stack bytes are filled with to find the high-water mark
+#define STACK_FILL_PATTERN          0x5A
 
 //! The bottom of the main stack. That is the highest address.
 #define BOTTOM_OF_MAIN_STACK        (AVR_SRAM_LAST)
@@ -87,12 +162,36 @@
 //! The bottom of the memory chunks for all process stacks. That is the highest address.
 #define BOTTOM_OF_PROCS_STACK       (BOTTOM_OF_ISR_STACK - STACK_SIZE_ISR)
 
-//! The bottom of the memory chunk with number PID.
-#define PROCESS_STACK_BOTTOM(PID)   (BOTTOM_OF_PROCS_STACK - ((PID) * STACK_SIZE_PROC))
+//! The lowest address of the region for all process stacks.
+#define STACK_REGION_LIMIT          (BOTTOM_OF_PROCS_STACK - STACK_REGION_SIZE + 1)
+
+//! Number of canary bytes at the limit of every process stack
+#define STACK_CANARY_SIZE           2
+
+//! Value of every canary byte
+#define STACK_CANARY_VALUE          0xA5
+
+//! Stack integrity mode the scheduler starts with (see StackIntegrityMode)
+#define STACK_INTEGRITY_MODE        OS_SI_CHECKSUM
+
+//! In mode OS_SI_SAMPLED only every n-th suspended stack gets a checksum
+#define STACK_INTEGRITY_SAMPLE_INTERVAL 8
+
+/*!
+ *  Bytes of globals every process beyond the eighth adds to the kernel tables
+ *  (process, statistics, periodic, budget, sync, sleep and scheduling entries
+ *  as well as the visit list of every heap), rounded up.
+ *  HEAPBOTTOM moves up by this much so the globals do not run into the heap.
+ */
+#define GLOBALS_SIZE_PER_PROCESS    100
 
 //由于我们的Project 300多Byte,所以需要大于(100+300) 作为栈底地址
-#define HEAPBOTTOM                  0x500
+#define HEAPBOTTOM                  (MAX_NUMBER_OF_PROCESSES > 8 ? 0x500 + GLOBALS_SIZE_PER_PROCESS * (MAX_NUMBER_OF_PROCESSES - 8) : 0x500)
 //栈顶
-#define HEAPCEILING					PROCESS_STACK_BOTTOM(MAX_NUMBER_OF_PROCESSES)
+#define HEAPCEILING					(STACK_REGION_LIMIT - 1)
+
+#if HEAPBOTTOM >= STACK_REGION_LIMIT
+    #error "Too many processes: the kernel tables and the process stacks leave no internal heap"
+#endif
 
 #endif
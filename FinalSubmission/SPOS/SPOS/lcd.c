@@ -1,7 +1,5 @@
 #include "lcd.h"
-#ifdef VERSUCH
-    #include "util.h"
-#endif
+#include "os_scheduler.h"
 
 #pragma GCC push_options
 #pragma GCC optimize ("O3")
@@ -149,11 +147,9 @@ void lcd_goto(unsigned char row, unsigned char column) {
  *  \param secondByte The second value to send.
  */
 void lcd_sendStream(uint8_t firstByte, uint8_t secondByte) {
-    // Check if interrupts are set and store that state
-    uint8_t sreg = SREG & (1 << 7);
-
-    // Interrupts off
-    cli();
+    // No other process may talk to the LCD meanwhile. Interrupts stay on,
+    // the busy wait can take a while and the timing of the LCD is not critical.
+    os_preemptDisable();
     uint16_t iterations = 0;
     bool busy = false;
 
@@ -187,8 +183,7 @@ void lcd_sendStream(uint8_t firstByte, uint8_t secondByte) {
             // Timeout: Try to reset LCD
             lcd_enable();
 
-            // Restore interrupt flag
-            SREG |= sreg;
+            os_preemptEnable();
             return;
         }
     } while (busy);
@@ -204,8 +199,7 @@ void lcd_sendStream(uint8_t firstByte, uint8_t secondByte) {
     LCD_PORT_DATA = secondByte;
     lcd_enable();
 
-    // Restore interrupt flag
-    SREG |= sreg;
+    os_preemptEnable();
 }
 
 /*!
@@ -227,9 +221,8 @@ void lcd_command(uint8_t command) {
  *  \param character  The character to be written.
  */
 void lcd_writeChar(char character) {
-    // Check if interrupts are set and store that state
-    uint8_t sreg = SREG & (1 << 7);
-    cli();
+    // The char counter and the cursor belong together
+    os_preemptDisable();
 
     // Check if line shall be changed
     if (character == '\n') {
@@ -285,8 +278,7 @@ void lcd_writeChar(char character) {
         charCtr++;
     }
 
-    // Restore interrupt flags
-    SREG |= sreg;
+    os_preemptEnable();
 }
 
 /*!
@@ -459,8 +451,7 @@ void lcd_writeProgString(char const* string) {
  *  \param chr The passed value is one 32 bit integer witch holds all rows of the character.
  */
 void lcd_registerCustomChar(uint8_t addr, uint64_t chr) {
-    uint8_t const sreg = SREG & (1 << 7);
-    cli();
+    os_preemptDisable();
     lcd_command(0x40 | (0x38 & (addr << 3)));
     _delay_us(40);
 
@@ -471,7 +462,7 @@ void lcd_registerCustomChar(uint8_t addr, uint64_t chr) {
         _delay_us(40);
         chr >>= 8;
     }
-    SREG |= sreg;
+    os_preemptEnable();
 }
 
 /*!
@@ -4,6 +4,7 @@
 #include "lcd.h"
 #include "os_input.h"
 #include "os_memheap_drivers.h"
+#include "os_scheduler.h"
 
 #include <avr/interrupt.h>
 #include <avr/common.h>
@@ -11,6 +12,7 @@
 #include <avr/interrupt.h>
 
 void os_initScheduler(void);
+bool os_setTickPeriod(uint16_t us);
 
 //variable specially forcing the c/c++ linker to not initialize the variable so we can detect its initialized state
 uint8_t softResetDetector __attribute__ ((section (".noinit")));
@@ -37,11 +39,8 @@ void os_init_timer(void) {
     // Init timer 2 (Scheduler)
     sbi(TCCR2A, WGM21); // Clear on timer compare match
 
-    sbi(TCCR2B, CS22); // Prescaler 1024  1
-    sbi(TCCR2B, CS21); // Prescaler 1024  1
-    sbi(TCCR2B, CS20); // Prescaler 1024  1
+    os_setTickPeriod(SCHEDULER_TICK_US); // Prescaler and compare value
     sbi(TIMSK2, OCIE2A); // Enable interrupt
-    OCR2A = 60;
 
     // Init timer 0 with prescaler 256
     cbi(TCCR0B, CS00);
@@ -49,6 +48,11 @@ void os_init_timer(void) {
     sbi(TCCR0B, CS02);
 
     sbi(TIMSK0, TOIE0);
+
+#if OS_MEASURE
+    // Init timer 1 (kernel latency measurement)
+    os_measureInit();
+#endif
 }
 
 /*!
@@ -130,11 +134,12 @@ void os_init(void) {
     os_checkSoftReset(1);
     delayMs(2000);
 
+    // Reset the clock before the autostart processes are stamped ready
+    os_systemTime_reset();
+
     os_initScheduler();
 	
     os_initHeaps();//init int Heap and ext Heap
-
-    os_systemTime_reset();
 }
 
 /*!
@@ -149,6 +154,11 @@ void os_errorPStr(char const* str) {
     
     SREG &= 0b01111111;
 	
+	// The nesting depth may be what the error is about, the LCD must not trip over it
+	uint8_t const oldCount = criticalSectionCount;
+	uint8_t const oldTimsk2 = TIMSK2;
+	criticalSectionCount = 0;
+	
 	lcd_clear();
 	lcd_writeProgString(str);
 	//lcd_writeProgString(PSTR(str)); // maybe * ?// lcd_writeProgString(PSTR) compiling with error
@@ -163,5 +173,7 @@ void os_errorPStr(char const* str) {
     //if vorSREG=0,we don't need to do anything, cuz MSB of SREG is 0 now, we just keep the SREG the same as it originally was
 
 	
+	criticalSectionCount = oldCount;
+	TIMSK2 = oldTimsk2;
 	SREG |= (oldSreg & 0b10000000);
 }
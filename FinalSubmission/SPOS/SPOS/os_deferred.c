@@ -0,0 +1,127 @@
+#include "os_deferred.h"
+#include "os_scheduler.h"
+#include <avr/interrupt.h>
+
+#if DEFERRED_QUEUE_SIZE & (DEFERRED_QUEUE_SIZE - 1) || DEFERRED_QUEUE_SIZE > 128
+#error "DEFERRED_QUEUE_SIZE has to be a power of two and at most 128"
+#endif
+
+//----------------------------------------------------------------------------
+// Private types and variables
+//----------------------------------------------------------------------------
+
+//! A queued procedure with its argument
+typedef struct {
+	DeferredProc* proc;
+	void* arg;
+} DeferredEntry;
+
+//! Ring buffer of the queued procedures
+DeferredEntry deferredQueue[DEFERRED_QUEUE_SIZE];
+
+//! Number of entries ever posted (mod 256), only written by os_deferPost
+volatile uint8_t deferredHead = 0;
+
+//! Number of entries ever taken (mod 256), only written by os_runDeferred
+volatile uint8_t deferredTail = 0;
+
+//! Number of procedures that did not fit into the queue
+uint16_t deferredDropped = 0;
+
+//! Set while os_runDeferred is running, so nested scheduler calls do not drain twice
+bool deferredRunning = false;
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Appends a procedure to the queue from an interrupt handler. Handlers never
+ *  nest and run with interrupts disabled, so the caller is the only writer of
+ *  deferredHead and no lock is taken. The entry is published by a single byte
+ *  store to deferredHead after it was filled, and os_runDeferred never holds
+ *  the queue while a procedure runs.
+ *
+ *  \param proc The procedure to run.
+ *  \param arg The argument passed to the procedure.
+ *  \return False if the queue is full (the procedure is dropped).
+ */
+bool os_deferPostFromIsr(DeferredProc* proc, void* arg) {
+	uint8_t const head = deferredHead;
+	if ((uint8_t)(head - deferredTail) >= DEFERRED_QUEUE_SIZE) {
+		deferredDropped++;
+		return false;
+	}
+	DeferredEntry* entry = &deferredQueue[head & (DEFERRED_QUEUE_SIZE - 1)];
+	entry->proc = proc;
+	entry->arg = arg;
+	deferredHead = head + 1;
+	// the queue is run by the next decision, which must not wait for a stretched idle tick
+	os_restoreTick();
+	return true;
+}
+
+/*!
+ *  Appends a procedure to the queue from a process or a deferred procedure.
+ *  An interrupt handler that posts as well would be a second writer of
+ *  deferredHead, so interrupts are off for the few instructions it takes to
+ *  fill the entry.
+ *
+ *  \param proc The procedure to run.
+ *  \param arg The argument passed to the procedure.
+ *  \return False if the queue is full (the procedure is dropped).
+ */
+bool os_deferPost(DeferredProc* proc, void* arg) {
+	uint8_t const sreg = os_irqSave();
+	bool const posted = os_deferPostFromIsr(proc, arg);
+	os_irqRestore(sreg);
+	return posted;
+}
+
+/*!
+ *  Runs at most DEFERRED_BUDGET queued procedures in the order they were
+ *  posted. Called by the scheduler on its stack with interrupts disabled,
+ *  before the strategy picks the next process. The procedures run in a
+ *  critical section with interrupts enabled, so other interrupt handlers can
+ *  post meanwhile but the scheduler tick cannot nest.
+ *  Work that does not fit into the budget waits for the next decision.
+ */
+void os_runDeferred(void) {
+	if (deferredHead == deferredTail || deferredRunning) {
+		return;
+	}
+	deferredRunning = true;
+	os_enterCriticalSection();
+	sei();
+	for (uint8_t budget = DEFERRED_BUDGET; budget && deferredHead != deferredTail; budget--) {
+		// Copy the entry first, the slot may be reused as soon as the tail moves on
+		uint8_t const tail = deferredTail;
+		DeferredEntry const entry = deferredQueue[tail & (DEFERRED_QUEUE_SIZE - 1)];
+		deferredTail = tail + 1;
+		entry.proc(entry.arg);
+	}
+	cli();
+	os_leaveCriticalSection();
+	deferredRunning = false;
+}
+
+/*!
+ *  Returns how many procedures wait in the queue.
+ *
+ *  \return The number of queued procedures.
+ */
+uint8_t os_getDeferredPending(void) {
+	return deferredHead - deferredTail;
+}
+
+/*!
+ *  Returns how many procedures os_deferPost dropped since the start.
+ *
+ *  \return The number of dropped procedures.
+ */
+uint16_t os_getDeferredDropped(void) {
+	uint8_t const sreg = os_irqSave();
+	uint16_t const dropped = deferredDropped;
+	os_irqRestore(sreg);
+	return dropped;
+}
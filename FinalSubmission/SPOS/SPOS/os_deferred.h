@@ -0,0 +1,53 @@
+/*! \file
+ *  \brief Deferred work (bottom halves) for interrupt handlers.
+ *
+ *  An interrupt handler posts a procedure and an argument to a fixed-size
+ *  queue instead of doing long work itself. The scheduler runs the queued
+ *  procedures on its own stack right before every scheduling decision, at most
+ *  DEFERRED_BUDGET of them per decision, with interrupts enabled but the
+ *  scheduler tick masked. So a process a procedure makes ready already takes
+ *  part in that decision. A deferred procedure may signal semaphores or post
+ *  further work, but it must never wait, sleep or yield.
+ *
+ *  The queue is a single-producer ring: head and tail each have one writer.
+ *  Interrupt handlers never nest, so os_deferPostFromIsr needs no lock at all.
+ *  Processes and deferred procedures can be interrupted by a handler that
+ *  posts as well, so os_deferPost keeps interrupts off while it fills the
+ *  entry.
+ */
+
+#ifndef _OS_DEFERRED_H
+#define _OS_DEFERRED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "defines.h"
+
+//----------------------------------------------------------------------------
+// Types
+//----------------------------------------------------------------------------
+
+//! This is the type of a deferred procedure (not the pointer to one!).
+typedef void DeferredProc(void* arg);
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! Queues a procedure, may be called from processes and deferred procedures
+bool os_deferPost(DeferredProc* proc, void* arg);
+
+//! Queues a procedure without a lock, only called by interrupt handlers
+bool os_deferPostFromIsr(DeferredProc* proc, void* arg);
+
+//! Runs queued procedures, only called by the scheduler
+void os_runDeferred(void);
+
+//! Returns the number of queued procedures
+uint8_t os_getDeferredPending(void);
+
+//! Returns the number of procedures that were dropped because the queue was full
+uint16_t os_getDeferredDropped(void);
+
+#endif
@@ -1,6 +1,20 @@
 #include <avr/io.h>
+#include <avr/interrupt.h>
 #include <stdint.h>
 #include "os_input.h"
+#include "defines.h"
+#include "util.h"
+
+//! Button pins on PORTC (ENTER, DOWN, UP, ESC)
+#define BUTTON_PINS 0b11000011
+
+//! ENTER + ESC as returned by os_getInput
+#define HOTKEY_MASK 0b00001001
+
+volatile bool os_hotkeyLatched = false;
+
+//! Raw system time at which ENTER and ESC were last found held down together
+static Time hotkeySince;
 
 /*!
  *  A simple "Getter"-Function for the Buttons on the evaluation board.\n
@@ -31,7 +45,46 @@ void os_initInput() {
 	DDRC &= 0b00111100;
 
 	// Pull-UP Widerst�nde aktivieren
-	PORTC |= 0b11000011;
+	PORTC |= BUTTON_PINS;
+
+	// Jede Flanke an den Buttons loest PCINT2 aus
+	PCMSK2 |= BUTTON_PINS;
+	PCICR |= (1 << PCIE2);
+}
+
+/*!
+ *  Pin change interrupt of the buttons. Latches the task manager hotkey
+ *  (ENTER + ESC) so the scheduler only has to test os_hotkeyLatched on every
+ *  tick. Bouncing contacts trigger this several times; the last edge decides
+ *  about the latch and restarts the debounce time.
+ */
+ISR(PCINT2_vect) {
+	if ((os_getInput() & HOTKEY_MASK) == HOTKEY_MASK) {
+		if (!os_hotkeyLatched) {
+			hotkeySince = os_systemTime_raw();
+			os_hotkeyLatched = true;
+		}
+	} else {
+		os_hotkeyLatched = false;
+	}
+}
+
+/*!
+ *  Only called while os_hotkeyLatched is set. The hotkey counts once both
+ *  buttons are still held down HOTKEY_DEBOUNCE_MS after they were latched.
+ *
+ *  \returns Whether the task manager is to be opened.
+ */
+bool os_hotkeyConfirmed(void) {
+	return (os_getInput() & HOTKEY_MASK) == HOTKEY_MASK
+		&& os_systemTime_raw() - hotkeySince >= TIME_MS_TO_RAW(HOTKEY_DEBOUNCE_MS);
+}
+
+/*!
+ *  Clears the latch, e.g. after the task manager was closed.
+ */
+void os_clearHotkey(void) {
+	os_hotkeyLatched = false;
 }
 
 
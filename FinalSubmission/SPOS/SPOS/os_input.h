@@ -12,6 +12,7 @@
 #define _OS_INPUT_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 //----------------------------------------------------------------------------
 // Function headers
@@ -29,4 +30,13 @@ void os_waitForNoInput(void);
 //! Waits for at least one button to be pressed
 void os_waitForInput(void);
 
+//! Set by the pin change interrupt while ENTER and ESC are held down together
+extern volatile bool os_hotkeyLatched;
+
+//! Checks whether the latched hotkey has been held down for the debounce time
+bool os_hotkeyConfirmed(void);
+
+//! Clears the hotkey latch after the hotkey has been handled
+void os_clearHotkey(void);
+
 #endif
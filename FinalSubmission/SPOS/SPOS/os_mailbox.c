@@ -0,0 +1,144 @@
+#include "os_mailbox.h"
+#include "os_memory.h"
+
+/*!
+ *  Allocates a shared chunk for capacity messages of msgSize bytes each on the
+ *  passed heap. As the chunk is shared, it stays valid when the creating
+ *  process terminates.
+ *
+ *  \param mbox The mailbox to initialize.
+ *  \param heap The heap the messages are kept on.
+ *  \param msgSize The size of every message in bytes.
+ *  \param capacity The maximum number of messages the mailbox holds.
+ *  \return False if the heap has no room for the buffer.
+ */
+bool os_mboxCreate(Mailbox* mbox, Heap* heap, uint8_t msgSize, uint8_t capacity) {
+	if (msgSize == 0 || capacity == 0) {
+		return false;
+	}
+	MemAddr buffer = os_sh_malloc(heap, (uint16_t)msgSize * capacity);
+	if (buffer == 0) {
+		return false;
+	}
+	mbox->heap = heap;
+	mbox->buffer = buffer;
+	mbox->msgSize = msgSize;
+	mbox->capacity = capacity;
+	mbox->head = 0;
+	mbox->tail = 0;
+	os_semInit(&mbox->freeSlots, capacity);
+	os_semInit(&mbox->usedSlots, 0);
+	os_mutexInit(&mbox->sendLock);
+	os_mutexInit(&mbox->receiveLock);
+	return true;
+}
+
+/*!
+ *  Frees the buffer of the mailbox. Messages that are still in it are lost.
+ *  No process may wait for the mailbox or use it afterwards.
+ *
+ *  \param mbox The mailbox.
+ */
+void os_mboxDestroy(Mailbox* mbox) {
+	MemAddr buffer = mbox->buffer;
+	os_sh_free(mbox->heap, &buffer);
+	mbox->buffer = 0;
+}
+
+/*!
+ *  Copies a message into the next free slot. The caller has reserved the slot
+ *  via freeSlots, the message becomes visible via usedSlots.
+ */
+static void os_mboxPut(Mailbox* mbox, void const* msg) {
+	os_mutexLock(&mbox->sendLock);
+	MemAddr addr = mbox->buffer + (uint16_t)mbox->tail * mbox->msgSize;
+	uint8_t const* src = msg;
+	for (uint8_t i = 0; i < mbox->msgSize; i++) {
+		mbox->heap->driver->write(addr + i, src[i]);
+	}
+	if (++mbox->tail == mbox->capacity) {
+		mbox->tail = 0;
+	}
+	os_mutexUnlock(&mbox->sendLock);
+	os_semSignal(&mbox->usedSlots);
+}
+
+/*!
+ *  Copies the oldest message out of the mailbox. The caller has reserved it
+ *  via usedSlots, the slot is returned via freeSlots.
+ */
+static void os_mboxTake(Mailbox* mbox, void* msg) {
+	os_mutexLock(&mbox->receiveLock);
+	MemAddr addr = mbox->buffer + (uint16_t)mbox->head * mbox->msgSize;
+	uint8_t* dest = msg;
+	for (uint8_t i = 0; i < mbox->msgSize; i++) {
+		dest[i] = mbox->heap->driver->read(addr + i);
+	}
+	if (++mbox->head == mbox->capacity) {
+		mbox->head = 0;
+	}
+	os_mutexUnlock(&mbox->receiveLock);
+	os_semSignal(&mbox->freeSlots);
+}
+
+/*!
+ *  Appends a message to the mailbox. While the mailbox is full, the process
+ *  waits without using the CPU.
+ *
+ *  \param mbox The mailbox.
+ *  \param msg The message (msgSize bytes).
+ */
+void os_mboxSend(Mailbox* mbox, void const* msg) {
+	os_semWait(&mbox->freeSlots);
+	os_mboxPut(mbox, msg);
+}
+
+/*!
+ *  Appends a message to the mailbox if it is not full.
+ *
+ *  \param mbox The mailbox.
+ *  \param msg The message (msgSize bytes).
+ *  \return True if the message was sent.
+ */
+bool os_mboxTrySend(Mailbox* mbox, void const* msg) {
+	if (!os_semTryWait(&mbox->freeSlots)) {
+		return false;
+	}
+	os_mboxPut(mbox, msg);
+	return true;
+}
+
+/*!
+ *  Takes the oldest message out of the mailbox. While the mailbox is empty,
+ *  the process waits without using the CPU.
+ *
+ *  \param mbox The mailbox.
+ *  \param msg Receives the message (msgSize bytes).
+ */
+void os_mboxReceive(Mailbox* mbox, void* msg) {
+	os_semWait(&mbox->usedSlots);
+	os_mboxTake(mbox, msg);
+}
+
+/*!
+ *  Takes the oldest message out of the mailbox if there is one.
+ *
+ *  \param mbox The mailbox.
+ *  \param msg Receives the message (msgSize bytes).
+ *  \return True if a message was received.
+ */
+bool os_mboxTryReceive(Mailbox* mbox, void* msg) {
+	if (!os_semTryWait(&mbox->usedSlots)) {
+		return false;
+	}
+	os_mboxTake(mbox, msg);
+	return true;
+}
+
+/*!
+ *  \param mbox The mailbox.
+ *  \return The number of messages that can be received right now.
+ */
+uint8_t os_mboxCount(Mailbox const* mbox) {
+	return mbox->usedSlots.count;
+}
@@ -0,0 +1,61 @@
+/*! \file
+ *  \brief Blocking message queues (mailboxes).
+ *
+ *  A mailbox passes messages of a fixed size between processes in FIFO order.
+ *  The messages are kept in a shared memory chunk on a heap of choice. Senders
+ *  wait in the kernel while the mailbox is full, receivers while it is empty.
+ */
+
+#ifndef _OS_MAILBOX_H
+#define _OS_MAILBOX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "os_memheap_drivers.h"
+#include "os_sync.h"
+
+//----------------------------------------------------------------------------
+// Types
+//----------------------------------------------------------------------------
+
+//! A message queue with its buffer on a heap
+typedef struct Mailbox {
+	Heap* heap;
+	MemAddr buffer;         //!< Shared chunk with room for capacity messages
+	uint8_t msgSize;
+	uint8_t capacity;
+	uint8_t head;           //!< Slot of the oldest message
+	uint8_t tail;           //!< Slot the next message is written to
+	Semaphore freeSlots;
+	Semaphore usedSlots;
+	Mutex sendLock;         //!< Serializes senders while they copy a message
+	Mutex receiveLock;      //!< Serializes receivers while they copy a message
+} Mailbox;
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! Allocates the buffer of a mailbox on the heap and initializes it
+bool os_mboxCreate(Mailbox* mbox, Heap* heap, uint8_t msgSize, uint8_t capacity);
+
+//! Frees the buffer of a mailbox nobody uses anymore
+void os_mboxDestroy(Mailbox* mbox);
+
+//! Appends a message, waits while the mailbox is full
+void os_mboxSend(Mailbox* mbox, void const* msg);
+
+//! Appends a message if there is room, never waits
+bool os_mboxTrySend(Mailbox* mbox, void const* msg);
+
+//! Takes the oldest message, waits while the mailbox is empty
+void os_mboxReceive(Mailbox* mbox, void* msg);
+
+//! Takes the oldest message if there is one, never waits
+bool os_mboxTryReceive(Mailbox* mbox, void* msg);
+
+//! Returns the number of messages in the mailbox
+uint8_t os_mboxCount(Mailbox const* mbox);
+
+#endif
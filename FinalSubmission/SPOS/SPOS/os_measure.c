@@ -0,0 +1,81 @@
+#include "os_measure.h"
+
+//----------------------------------------------------------------------------
+// Private variables
+//----------------------------------------------------------------------------
+
+//! Statistics of every category
+static MeasureStats measureStats[MEASURE_CATEGORY_COUNT];
+
+uint16_t measurePreemptStart = 0;
+uint16_t measureIrqStart = 0;
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Lets Timer 1 run freely with prescaler 8 and clears the statistics.
+ *  Called by os_init_timer if OS_MEASURE is set.
+ */
+void os_measureInit(void) {
+	TCCR1A = 0;
+	TCCR1B = (1 << CS11);
+	os_measureReset();
+}
+
+/*!
+ *  Adds a duration to the statistics of a category. Called by the hooks with
+ *  interrupts enabled or disabled, so it disables them itself without going
+ *  through os_irqSave, which is measured.
+ *
+ *  \param category The kernel path the duration belongs to.
+ *  \param ticks The duration in Timer 1 counts.
+ */
+void os_measureRecord(MeasureCategory category, uint16_t ticks) {
+	uint8_t bucket = 0;
+	for (uint16_t t = ticks >> 3; t && bucket < MEASURE_BUCKETS - 1; t >>= 1) {
+		bucket++;
+	}
+
+	uint8_t const sreg = SREG;
+	__asm__ volatile ("cli" ::: "memory");
+	MeasureStats* stats = &measureStats[category];
+	if (stats->count != UINT16_MAX) {
+		stats->count++;
+		stats->sum += ticks;
+	}
+	if (ticks < stats->min) {
+		stats->min = ticks;
+	}
+	if (ticks > stats->max) {
+		stats->max = ticks;
+	}
+	if (stats->buckets[bucket] != UINT16_MAX) {
+		stats->buckets[bucket]++;
+	}
+	SREG = sreg;
+}
+
+/*!
+ *  Clears the statistics of all categories.
+ */
+void os_measureReset(void) {
+	uint8_t const sreg = SREG;
+	__asm__ volatile ("cli" ::: "memory");
+	for (uint8_t i = 0; i < MEASURE_CATEGORY_COUNT; i++) {
+		measureStats[i] = (MeasureStats){ .min = UINT16_MAX };
+	}
+	SREG = sreg;
+}
+
+/*!
+ *  Returns the statistics of a category. The average is sum / count, both
+ *  stop growing once count saturates.
+ *
+ *  \param category The kernel path.
+ *  \return The statistics, all durations in Timer 1 counts.
+ */
+MeasureStats const* os_getMeasureStats(MeasureCategory category) {
+	return &measureStats[category];
+}
@@ -0,0 +1,110 @@
+/*! \file
+ *  \brief Kernel latency measurement with Timer 1.
+ *
+ *  With OS_MEASURE set in defines.h, Timer 1 runs freely with prescaler 8
+ *  (0.4 us per count at 20 MHz) and timestamps the scheduler interrupt, the
+ *  voluntary context switch, the scheduling decision, the sections preemption
+ *  is disabled in and the sections os_irqSave disables interrupts in. Every
+ *  category keeps its count, minimum, average and maximum duration and a
+ *  histogram, which the task manager shows. Without OS_MEASURE the hooks
+ *  compile to nothing.
+ *
+ *  Sections longer than 26 ms wrap around and are recorded too short. The
+ *  scheduler interrupt is timed from after its context was saved until right
+ *  before it is restored.
+ */
+
+#ifndef _OS_MEASURE_H
+#define _OS_MEASURE_H
+
+#include <stdint.h>
+#include <avr/io.h>
+
+#include "defines.h"
+
+//----------------------------------------------------------------------------
+// Types
+//----------------------------------------------------------------------------
+
+//! The kernel paths that are measured
+typedef enum MeasureCategory {
+	OS_MC_TICK,         //!< Scheduler interrupt (TIMER2_COMPA_vect)
+	OS_MC_SWITCH,       //!< Voluntary context switch (os_yield, waiting, sleeping)
+	OS_MC_DISPATCH,     //!< Scheduling decision of both switches
+	OS_MC_PREEMPT_OFF,  //!< Outermost critical section or os_preemptDisable
+	OS_MC_IRQ_OFF       //!< Interrupts disabled by os_irqSave
+} MeasureCategory;
+
+#define MEASURE_CATEGORY_COUNT 5
+
+//! Number of histogram buckets, bucket i counts durations below 8 << i Timer 1 counts
+#define MEASURE_BUCKETS 10
+
+//! Durations of one category in Timer 1 counts
+typedef struct MeasureStats {
+	uint16_t count;         //!< Number of samples (saturates)
+	uint16_t min;
+	uint16_t max;
+	uint32_t sum;
+	uint16_t buckets[MEASURE_BUCKETS];
+} MeasureStats;
+
+//! Converts Timer 1 counts to us
+#define MEASURE_TICKS_TO_US(t) ((uint32_t)(t) * 8ul / (F_CPU / 1000000ul))
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! Starts Timer 1 and clears the statistics
+void os_measureInit(void);
+
+//! Adds a duration (in Timer 1 counts) to a category
+void os_measureRecord(MeasureCategory category, uint16_t ticks);
+
+//! Clears the statistics of all categories
+void os_measureReset(void);
+
+//! Returns the statistics of a category
+MeasureStats const* os_getMeasureStats(MeasureCategory category);
+
+//----------------------------------------------------------------------------
+// Hooks
+//----------------------------------------------------------------------------
+
+#if OS_MEASURE
+
+//! Start of the current section with preemption disabled
+extern uint16_t measurePreemptStart;
+
+//! Start of the current section with interrupts disabled by os_irqSave
+extern uint16_t measureIrqStart;
+
+/*!
+ *  Reads Timer 1. The 16 bit read goes through a shared temporary register,
+ *  so it must not be interrupted by another read.
+ *
+ *  \return The current count of Timer 1.
+ */
+static inline uint16_t os_measureNow(void) {
+	uint8_t const sreg = SREG;
+	__asm__ volatile ("cli" ::: "memory");
+	uint16_t const now = TCNT1;
+	SREG = sreg;
+	return now;
+}
+
+//! Declares VAR and stores the current time in it
+#define MEASURE_START(VAR) uint16_t const VAR = os_measureNow()
+
+//! Records the time since MEASURE_START(VAR) in CATEGORY
+#define MEASURE_END(CATEGORY, VAR) os_measureRecord((CATEGORY), os_measureNow() - (VAR))
+
+#else
+
+#define MEASURE_START(VAR)
+#define MEASURE_END(CATEGORY, VAR)
+
+#endif
+
+#endif
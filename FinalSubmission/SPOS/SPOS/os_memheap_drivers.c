@@ -3,15 +3,19 @@
 #include "os_core.h"
 #include <avr/pgmspace.h>
 
-#define MAP_AREA_SIZE	((HEAPCEILING - HEAPBOTTOM) / 3)
+// Die Map belegt beim Nibble-Format 1/3, beim Byte-Format 1/2 des Heaps
+#define MAP_SIZE_OF(FORMAT, TOTAL)	((FORMAT) == OS_MAP_BYTE ? (TOTAL) / 2 : (TOTAL) / 3)
+#define USE_SIZE_OF(FORMAT, TOTAL)	((FORMAT) == OS_MAP_BYTE ? MAP_SIZE_OF(FORMAT, TOTAL) : MAP_SIZE_OF(FORMAT, TOTAL) * 2)
+
+#define MAP_AREA_SIZE	MAP_SIZE_OF(INT_HEAP_MAP_FORMAT, HEAPCEILING - HEAPBOTTOM)
 #define USE_AREA_START	(HEAPBOTTOM + MAP_AREA_SIZE)
-#define USE_AREA_SIZE	(MAP_AREA_SIZE * 2)
+#define USE_AREA_SIZE	USE_SIZE_OF(INT_HEAP_MAP_FORMAT, HEAPCEILING - HEAPBOTTOM)
 
 #define EXT_SRAM_SIZE		63999 //64KiB?
 #define EXT_HEAPBOTTOM		(0x0)
-#define EXT_MAP_AREA_SIZE	(EXT_SRAM_SIZE / 3)
-#define EXT_USE_AREA_START	(EXT_MAP_AREA_SIZE)
-#define EXT_USE_AREA_SIZE	((EXT_SRAM_SIZE / 3) * 2)
+#define EXT_MAP_AREA_SIZE	MAP_SIZE_OF(EXT_HEAP_MAP_FORMAT, EXT_SRAM_SIZE)
+#define EXT_USE_AREA_START	(EXT_HEAPBOTTOM + EXT_MAP_AREA_SIZE)
+#define EXT_USE_AREA_SIZE	USE_SIZE_OF(EXT_HEAP_MAP_FORMAT, EXT_SRAM_SIZE)
 
 
 extern uint8_t const __heap_start;
@@ -27,6 +31,7 @@ Heap intHeap__ = {
 	.mapSize = MAP_AREA_SIZE,
 	.useStart = USE_AREA_START,
 	.useSize = USE_AREA_SIZE,
+	.mapFormat = INT_HEAP_MAP_FORMAT,
 	.allocStrategy = OS_MEM_FIRST,
 	.nextFit = USE_AREA_START,
 	.name = intStr,
@@ -39,6 +44,7 @@ Heap extHeap__ = {
 	.mapSize = EXT_MAP_AREA_SIZE,
 	.useStart = EXT_USE_AREA_START,
 	.useSize = EXT_USE_AREA_SIZE,
+	.mapFormat = EXT_HEAP_MAP_FORMAT,
 	.allocStrategy = OS_MEM_FIRST,
 	.nextFit = EXT_USE_AREA_START,
 	.name = extStr,	
@@ -51,8 +57,16 @@ void checkIntHeapStart() {
 	}
 }
 
+// Die Nibble-Map kennt nur die Besitzer 1-7
+void checkMapFormats() {
+	if (MAX_NUMBER_OF_PROCESSES > 8 && (intHeap__.mapFormat == OS_MAP_NIBBLE || extHeap__.mapFormat == OS_MAP_NIBBLE)) {
+		os_error("! nibble map !!  > 8 processes !");
+	}
+}
+
 void os_initHeaps() {
 	checkIntHeapStart();
+	checkMapFormats();
 	
 	for (MemAddr i = 0; i < intHeap__.mapSize; i++) {
 		intSRAM->write(intHeap__.mapStart + i, (MemValue)0x00);
@@ -2,6 +2,7 @@
 #define _OS_MEMHEAP_DRIVERS_H
 
 #include "os_mem_drivers.h"
+#include "defines.h"
 #include <stddef.h>
 
 //! Zeigt auf den Heap `intHeap__`
@@ -16,6 +17,12 @@ typedef enum AllocStrategy {
 	OS_MEM_WORST
 } AllocStrategy;
 
+//! How the allocation map of a heap stores the owner of each byte of the use area.
+typedef enum MapFormat {
+	OS_MAP_NIBBLE,  //!< A nibble per byte: owners 1-7, shared 8-E, continuation F (the map takes 1/3 of the heap)
+	OS_MAP_BYTE     //!< A byte per byte: owners 1-0x7F, shared 0x80-0xFE, continuation 0xFF (the map takes 1/2 of the heap)
+} MapFormat;
+
 
 typedef struct Heap {
 	// Einen Zeiger auf den Speichertreiber, welcher dem Heap assoziiert ist
@@ -24,10 +31,11 @@ typedef struct Heap {
 	uint16_t mapSize;
 	uint16_t useStart;
 	uint16_t useSize;
+	MapFormat mapFormat;
 	AllocStrategy allocStrategy;
 	uint16_t nextFit;
 	const char *name;//the name of this heap
-	uint16_t procVisitArea[7];
+	uint16_t procVisitArea[MAX_NUMBER_OF_PROCESSES - 1];
 } Heap;
 
 //Initialises all Heaps.
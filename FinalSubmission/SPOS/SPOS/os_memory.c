@@ -3,14 +3,51 @@
 #include "os_process.h"
 #include "os_memheap_drivers.h"
 #include "os_core.h"
+#include "os_sync.h"
 #include "lcd.h"
 #include "os_input.h"
 
+/*!
+ *  Map entry of the bytes that continue a chunk.
+ *
+ *  \param heap The heap whose map format is used.
+ */
+MemValue os_getMapContinuationValue(Heap const *heap) {
+	return heap->mapFormat == OS_MAP_BYTE ? 0xFF : 0xF;
+}
+
+/*!
+ *  Map entry of a shared chunk that nobody has opened. Every reader adds one,
+ *  a writer sets the entry below the continuation value. All smaller non-zero
+ *  values are owners (process ids).
+ *
+ *  \param heap The heap whose map format is used.
+ */
+MemValue os_getMapSharedValue(Heap const *heap) {
+	return heap->mapFormat == OS_MAP_BYTE ? 0x80 : 0x8;
+}
+
+//! Map entry of a shared chunk that is opened for writing.
+static MemValue mapWriterValue(Heap const *heap) {
+	return os_getMapContinuationValue(heap) - 1;
+}
+
+/*!
+ *  Returns how much of the heap the map takes (in percent).
+ *
+ *  \param heap The heap to look at.
+ */
+uint8_t os_getMapOverhead(Heap const *heap) {
+	return (100ul * heap->mapSize) / ((uint32_t)heap->mapSize + heap->useSize);
+}
+
 MemAddr getMapAddrForUseAddr(Heap const *heap, MemAddr addr) {
 	// relative position im use-bereich
 	addr -= heap->useStart;
-	// halbieren
-	addr /= 2;
+	// halbieren, falls zwei Einträge in ein Byte passen
+	if (heap->mapFormat == OS_MAP_NIBBLE) {
+		addr /= 2;
+	}
 	// relative position im map-bereich
 	return addr + heap->mapStart;
 }
@@ -98,16 +135,18 @@ void assertAddrInUseArea(Heap const *heap, MemAddr addr) {
  *  \param addr	Die Adresse, dessen Verwaltungs-Nibble gelesen werden soll.
  */
 MemValue os_getMapEntry (Heap const *heap, MemAddr addr) {
-	os_enterCriticalSection();
+	os_preemptDisable();
 	assertAddrInUseArea(heap, addr);
 	MemAddr mapAddr = getMapAddrForUseAddr(heap, addr);
 	uint8_t nibble;
-	if (isMapHighNibbleForUseAddr(heap, addr)) {
+	if (heap->mapFormat == OS_MAP_BYTE) {
+		nibble = heap->driver->read(mapAddr);
+	} else if (isMapHighNibbleForUseAddr(heap, addr)) {
 		nibble = getHighNibble(heap, mapAddr);
 	} else {
 		nibble = getLowNibble(heap, mapAddr);
 	}
-	os_leaveCriticalSection();
+	os_preemptEnable();
 	return nibble;
 }
 
@@ -115,12 +154,14 @@ MemValue os_getMapEntry (Heap const *heap, MemAddr addr) {
  *  \brief Setzt zugehöriges Allok-Tabellen-Nibble für Use-Adresse.
  *
  *  \param addr	The address in use space for which the corresponding map entry shall be set
- *  \param value	Was in den map-nibble rein soll (valid range: 0x0 - 0xF)
+ *  \param value	Was in den map-nibble rein soll (valid range: 0x0 - 0xF, beim Byte-Format 0x00 - 0xFF)
  */
 void setMapEntry (Heap const *heap, MemAddr addr, MemValue value) {
 	assertAddrInUseArea(heap, addr);
 	MemAddr mapAddr = getMapAddrForUseAddr(heap, addr);
-	if (isMapHighNibbleForUseAddr(heap, addr)) {
+	if (heap->mapFormat == OS_MAP_BYTE) {
+		heap->driver->write(mapAddr, value);
+	} else if (isMapHighNibbleForUseAddr(heap, addr)) {
 		setHighNibble(heap, mapAddr, value);
 	} else {
 		setLowNibble(heap, mapAddr, value);
@@ -130,28 +171,28 @@ void setMapEntry (Heap const *heap, MemAddr addr, MemValue value) {
 
 //! Get the address of the first byte of chunk.
 MemAddr getFirstByteOfChunk(Heap const *heap, MemAddr addr) {
-	while (os_getMapEntry(heap, addr) == 0xF) {
+	while (os_getMapEntry(heap, addr) == os_getMapContinuationValue(heap)) {
 		addr--;
 	}
 	return addr;
 }
 
 ProcessID getOwnerOfChunk(Heap const *heap, MemAddr addr) {
-	os_enterCriticalSection();
-	while (os_getMapEntry(heap, addr) == 0xF) {
+	os_preemptDisable();
+	while (os_getMapEntry(heap, addr) == os_getMapContinuationValue(heap)) {
 		addr--;
 	}
 	uint8_t owner = os_getMapEntry(heap, addr);
-	os_leaveCriticalSection();
+	os_preemptEnable();
 	return owner;
 }
 
 //! Get the size of a chunk on a given address.
 uint16_t os_getChunkSize (Heap const *heap, MemAddr addr) {
-	os_enterCriticalSection();
+	os_preemptDisable();
 
 	if (os_getMapEntry(heap, addr) == 0) {
-		os_leaveCriticalSection();
+		os_preemptEnable();
 		return 0;
 	}
 
@@ -160,19 +201,19 @@ uint16_t os_getChunkSize (Heap const *heap, MemAddr addr) {
 	MemAddr right = addr;
 	// einen weiterschieben, um beim potentiellen F zu sein
 	right++;
-	while (os_getMapEntry(heap, right) == 0xF) {
+	while (os_getMapEntry(heap, right) == os_getMapContinuationValue(heap)) {
 		right++;
 	}
 
-	os_leaveCriticalSection();
+	os_preemptEnable();
 	return right - addr;
 }
 
 void os_freeOwnerRestricted(Heap *heap, MemAddr addr, ProcessID owner) {
-	os_enterCriticalSection();
+	os_preemptDisable();
 	
 	uint8_t actualOwner = getOwnerOfChunk(heap, addr);
-	if (actualOwner == 0xF) {
+	if (actualOwner == os_getMapContinuationValue(heap)) {
 		os_error("mem.c: ass err  wrong owner");
 	} else if (owner != actualOwner) {
 		os_error("u shall not freewhat is not thee");
@@ -182,12 +223,12 @@ void os_freeOwnerRestricted(Heap *heap, MemAddr addr, ProcessID owner) {
 	setMapEntry(heap, addr, 0);
 	addr++;
 	//           addr liegt im use bereich                 &&     in der allocTable steht F
-	while (addr < (heap->useStart + heap->useSize) && os_getMapEntry(heap, addr) == 0xF) {
+	while (addr < (heap->useStart + heap->useSize) && os_getMapEntry(heap, addr) == os_getMapContinuationValue(heap)) {
 		setMapEntry(heap, addr, 0);
 		addr++;
 	}
 	
-	os_leaveCriticalSection();
+	os_preemptEnable();
 }
 
 //! Returns the current memory management strategy.
@@ -197,16 +238,16 @@ AllocStrategy os_getAllocationStrategy (Heap const *heap) {
 
 //! Changes the memory management strategy.
 void os_setAllocationStrategy (Heap *heap, AllocStrategy allocStrat) {
-	os_enterCriticalSection();
+	os_preemptDisable();
 	heap->allocStrategy = allocStrat;
-	os_leaveCriticalSection();
+	os_preemptEnable();
 }
 
 /*!
  *  tries to get a mem chunk. MUST BE CALLED INSIDE CRITICAL SECTION!
  */
 MemAddr getMemoryChunk(Heap *heap, uint16_t size, uint8_t owner) {
-	os_enterCriticalSection();
+	os_preemptDisable();
 	MemAddr chunk = 0;
 
 	switch (os_getAllocationStrategy(heap)) {
@@ -225,7 +266,7 @@ MemAddr getMemoryChunk(Heap *heap, uint16_t size, uint8_t owner) {
 	}
 
 	if (chunk == 0) {
-		os_leaveCriticalSection();
+		os_preemptEnable();
 		return 0;
 	}
 
@@ -236,10 +277,10 @@ MemAddr getMemoryChunk(Heap *heap, uint16_t size, uint8_t owner) {
 	
 	MemAddr c = chunk + 1;
 	while (size-- > 0) {
-		setMapEntry(heap, c++, 0xF);
+		setMapEntry(heap, c++, os_getMapContinuationValue(heap));
 	}
 
-	os_leaveCriticalSection();
+	os_preemptEnable();
 	return chunk;
 }
 
@@ -249,6 +290,10 @@ MemAddr os_malloc(Heap *heap, uint16_t size) {
 	if (size == 0) {
 		return 0;
 	}
+	// Die Nibble-Map kann nur die Besitzer 1-7 speichern
+	if (os_getCurrentProc() >= os_getMapSharedValue(heap)) {
+		return 0;
+	}
 
 	return getMemoryChunk(heap, size, os_getCurrentProc());
 }
@@ -256,7 +301,7 @@ MemAddr os_malloc(Heap *heap, uint16_t size) {
 /*!
  *  alloziert shared memory.
  *
- * map entry Protokoll:
+ * map entry Protokoll (Nibble-Format, beim Byte-Format 0x80, 0x81-0xFD und 0xFE):
  *  - 8:	sharemd memory mit 0 lesenden, 0 schreibenden
  *  - 9-D:	shared memory mit x-8 lesenden (z.B. map entry C => 4 lesen grade dieses bit.
  *  - E:	ein Prozess liest
@@ -268,43 +313,43 @@ MemAddr os_sh_malloc(Heap *heap, uint16_t size) {
 		return 0;
 	}
 
-	return getMemoryChunk(heap, size, 0x8);
+	return getMemoryChunk(heap, size, os_getMapSharedValue(heap));
 }
 
 void os_sh_free(Heap *heap, MemAddr *ptr) {
 
-	os_enterCriticalSection();
-	if (getOwnerOfChunk(heap, *ptr) < 8) {
+	os_preemptDisable();
+	if (getOwnerOfChunk(heap, *ptr) < os_getMapSharedValue(heap)) {
 		lcd_clear();
 		lcd_writeProgString(PSTR("ERROR:os_sh_free  on non-shm"));
 		os_waitForInput();
-		os_leaveCriticalSection();
+		os_preemptEnable();
 		return;
 	}
 
-	while (getOwnerOfChunk(heap, *ptr) != 0x8) {
+	while (getOwnerOfChunk(heap, *ptr) != os_getMapSharedValue(heap)) {
 		os_yield();
 	}
 
-	os_freeOwnerRestricted(heap, *ptr, 8);
+	os_freeOwnerRestricted(heap, *ptr, os_getMapSharedValue(heap));
 
-	os_leaveCriticalSection();
+	os_preemptEnable();
 }
 
 //! Function used by processes to free their own allocated memory.
 void os_free (Heap *heap, MemAddr addr) {
-	os_enterCriticalSection();
+	os_preemptDisable();
 	
-	if (getOwnerOfChunk(heap, addr) > 7) {
+	if (getOwnerOfChunk(heap, addr) >= os_getMapSharedValue(heap)) {
 		lcd_clear();
 		lcd_writeProgString(PSTR("ERROR! os_free  on shared mem"));
 		os_waitForInput();
-		os_leaveCriticalSection();
+		os_preemptEnable();
 		return;
 	}
 	
 	os_freeOwnerRestricted(heap, addr, os_getCurrentProc());
-	os_leaveCriticalSection();
+	os_preemptEnable();
 }
 
 //! Get the size of the heap-map.
@@ -337,7 +382,7 @@ MemAddr os_getUseStart (Heap const *heap) {
  *
  */
 void os_freeProcessMemory (Heap *heap, ProcessID pid) {
-	os_enterCriticalSection();
+	os_preemptDisable();
 	// for-Schleife läuft bits der procVisit bitmap durch
 	for (int j = 0; j < 16; j++) {
 		// falls das aktuelle bit gesetzt ist...
@@ -356,7 +401,7 @@ void os_freeProcessMemory (Heap *heap, ProcessID pid) {
 		}
 	}
 	heap->procVisitArea[pid - 1] = 0x0;
-	os_leaveCriticalSection();
+	os_preemptEnable();
 }
 
 void moveChunk (Heap *heap, MemAddr oldChunk, size_t oldSize, MemAddr newChunk, size_t newSize){
@@ -365,19 +410,19 @@ void moveChunk (Heap *heap, MemAddr oldChunk, size_t oldSize, MemAddr newChunk,
 		os_error("newSize < oldSize");
 	}
 	
-	os_enterCriticalSection();
+	os_preemptDisable();
 	
 	setMapEntry(heap, newChunk, getOwnerOfChunk(heap, oldChunk));
 	heap->driver->write(newChunk, heap->driver->read(oldChunk));
 	setMapEntry(heap, oldChunk, 0x0);
 
 	for (MemAddr i = 1; i < oldSize; i++) {
-		setMapEntry(heap, newChunk + i, 0xF);
+		setMapEntry(heap, newChunk + i, os_getMapContinuationValue(heap));
 		heap->driver->write(newChunk + i, heap->driver->read(oldChunk + i));
 		setMapEntry(heap, oldChunk + i, 0x0);
 	}
 	
-	os_leaveCriticalSection();
+	os_preemptEnable();
 }
 
 MemAddr os_realloc(Heap* heap, MemAddr addr, uint16_t size){
@@ -387,7 +432,7 @@ MemAddr os_realloc(Heap* heap, MemAddr addr, uint16_t size){
 		return 0;
 	}
 
-	os_enterCriticalSection();
+	os_preemptDisable();
 	MemAddr chunkStart = getFirstByteOfChunk(heap, addr);
 	uint16_t chunkSize = os_getChunkSize(heap, chunkStart);
 	// linkeste noch freie Adresse ausgehend von chunkStart
@@ -401,7 +446,7 @@ MemAddr os_realloc(Heap* heap, MemAddr addr, uint16_t size){
 			right--;
 			setMapEntry(heap, right, 0x0);
 		}
-		os_leaveCriticalSection();
+		os_preemptEnable();
 		return chunkStart;
 	}
 	
@@ -416,9 +461,9 @@ MemAddr os_realloc(Heap* heap, MemAddr addr, uint16_t size){
 	if ((right - chunkStart) >= size) {
 		while (right  > chunkStart + chunkSize) {
 			right--;
-			setMapEntry(heap, right, 0xF);
+			setMapEntry(heap, right, os_getMapContinuationValue(heap));
 		}
-		os_leaveCriticalSection();
+		os_preemptEnable();
 		return chunkStart;
 	}
 
@@ -433,9 +478,9 @@ MemAddr os_realloc(Heap* heap, MemAddr addr, uint16_t size){
 	if ((right - left) >= size) {
 		moveChunk(heap, chunkStart, chunkSize, left, size);
 		for (MemAddr i = chunkSize; i < size; i++) {
-			setMapEntry(heap, left + i, 0xF);
+			setMapEntry(heap, left + i, os_getMapContinuationValue(heap));
 		}
-		os_leaveCriticalSection();
+		os_preemptEnable();
 		setProcVisitBit(heap, left);
 		return left;
 	}
@@ -445,74 +490,78 @@ MemAddr os_realloc(Heap* heap, MemAddr addr, uint16_t size){
 	if (newChunk != 0) {
 		moveChunk(heap, chunkStart, chunkSize, newChunk, size);
 	}
-	os_leaveCriticalSection();
+	os_preemptEnable();
 	setProcVisitBit(heap, newChunk);
 	return newChunk;
 }
 
 MemAddr os_sh_readOpen(Heap const* heap, MemAddr const *ptr) {
-	os_enterCriticalSection();
+	os_preemptDisable();
 
-	if (getOwnerOfChunk(heap, *ptr) < 8) {
+	if (getOwnerOfChunk(heap, *ptr) < os_getMapSharedValue(heap)) {
 		/*
 		lcd_clear();
 		lcd_writeProgString(PSTR("os_sh_readOpen on non-sm"));
 		os_waitForInput();
 		*/
 		os_error("os_sh_readOpen on non-sm");
-		os_leaveCriticalSection();
+		os_preemptEnable();
 		return 0;
 	}
 
 	// 0xD => maximal viele lesen, 0xE => einer schreibt
-	while (getOwnerOfChunk(heap, *ptr) > 0xC) {
-		os_yield();
+	// wer den Chunk offen hat, erbt beim Warten unsere Priorität
+	// nach jedem Schließen wird neu geprüft, ob wir öffnen dürfen
+	while (getOwnerOfChunk(heap, *ptr) >= mapWriterValue(heap) - 1) {
+		os_syncChunkWait(heap, getFirstByteOfChunk(heap, *ptr));
 	}
 
 	MemAddr addr = getFirstByteOfChunk(heap, *ptr);
 	setMapEntry(heap, addr, os_getMapEntry(heap, addr) + 1);
+	os_syncChunkOpened(heap, addr);
 
-	os_leaveCriticalSection();
+	os_preemptEnable();
 	return addr;
 }
 
 MemAddr os_sh_writeOpen(Heap const* heap, MemAddr const *ptr) {
-	os_enterCriticalSection();
+	os_preemptDisable();
 
-	if (getOwnerOfChunk(heap, *ptr) < 8) {
+	if (getOwnerOfChunk(heap, *ptr) < os_getMapSharedValue(heap)) {
 		/*
 		lcd_clear();
 		lcd_writeProgString(PSTR("os_sh_writeOpen on non-sm"));
 		os_waitForInput();
 		*/
 		os_error("os_sh_writeOpen on non-sm");
-		os_leaveCriticalSection();
+		os_preemptEnable();
 		return 0;
 	}
 
-	while (getOwnerOfChunk(heap, *ptr) != 0x8) {
-		os_yield();
+	while (getOwnerOfChunk(heap, *ptr) != os_getMapSharedValue(heap)) {
+		os_syncChunkWait(heap, getFirstByteOfChunk(heap, *ptr));
 	}
 
 	MemAddr addr = getFirstByteOfChunk(heap, *ptr);
-	setMapEntry(heap, addr, 0xE);
+	setMapEntry(heap, addr, mapWriterValue(heap));
+	os_syncChunkOpened(heap, addr);
 
 	addr = *ptr;
-	os_leaveCriticalSection();
+	os_preemptEnable();
 	return addr;
 }
 
 void os_sh_close(Heap const* heap, MemAddr addr) {
-	os_enterCriticalSection();
+	os_preemptDisable();
 
-	if (getOwnerOfChunk(heap, addr) < 8) {
+	if (getOwnerOfChunk(heap, addr) < os_getMapSharedValue(heap)) {
 		/*
 		lcd_clear();
 		lcd_writeProgString(PSTR("os_sh_close on non-sm"));
 		os_waitForInput();
 		*/
 		os_error("os_sh_close on non-sm");
-		os_leaveCriticalSection();
+		os_preemptEnable();
 		return;
 	}
 
@@ -520,27 +569,28 @@ void os_sh_close(Heap const* heap, MemAddr addr) {
 
 	uint8_t x = os_getMapEntry(heap, addr);
 
-	if (x < 9) {
+	if (x <= os_getMapSharedValue(heap)) {
 		os_error("closing on already closed");
 	}
 
-	int setTo = x == 0xE ? 0x8 : x - 1;
+	int setTo = x == mapWriterValue(heap) ? os_getMapSharedValue(heap) : x - 1;
 	setMapEntry(heap, addr, setTo);
+	os_syncChunkClosed(heap, addr);
 
-	os_leaveCriticalSection();
+	os_preemptEnable();
 }
 
 bool inBounds(Heap const* heap, MemAddr const* ptr, uint16_t end) {
-	os_enterCriticalSection();
+	os_preemptDisable();
 	MemAddr addr = getFirstByteOfChunk(heap, *ptr);
 	bool in = getFirstByteOfChunk(heap, addr) == getFirstByteOfChunk(heap, addr + end);
-	os_leaveCriticalSection();
+	os_preemptEnable();
 	return in;
 }
 
 void os_sh_read(Heap const* heap, MemAddr const* ptr, uint16_t offset, MemValue* dataDest, uint16_t length) {
 
-	os_enterCriticalSection();
+	os_preemptDisable();
 
 	if (!inBounds(heap, ptr, offset + length - 1)) {
 		/*
@@ -549,27 +599,27 @@ void os_sh_read(Heap const* heap, MemAddr const* ptr, uint16_t offset, MemValue*
 		os_waitForInput();
 		*/
 		os_error("ERROR!ptr not in sm bounds");
-		os_leaveCriticalSection();
+		os_preemptEnable();
 		return;
 	}
 
 	MemAddr addr = os_sh_readOpen(heap, ptr);
-	os_leaveCriticalSection();
+	os_preemptEnable();
 
 	for (MemAddr i = 0; i < length; ++i) {
-		os_enterCriticalSection();
+		os_preemptDisable();
 		*(dataDest + i) = heap->driver->read(getFirstByteOfChunk(heap, addr) + offset + i);
-		os_leaveCriticalSection();
+		os_preemptEnable();
 	}
 
-	os_enterCriticalSection();
+	os_preemptDisable();
 	os_sh_close(heap, addr);
-	os_leaveCriticalSection();
+	os_preemptEnable();
 }
 
 void os_sh_write(Heap const* heap, MemAddr const* ptr, uint16_t offset, MemValue const* dataSrc, uint16_t length) {
 
-	os_enterCriticalSection();
+	os_preemptDisable();
 	if (!inBounds(heap, ptr, offset + length - 1)) {
 		/*
 		lcd_clear();
@@ -577,17 +627,17 @@ void os_sh_write(Heap const* heap, MemAddr const* ptr, uint16_t offset, MemValue
 		os_waitForInput();
 		*/
 		os_error("ERROR!ptr not in sm bounds");
-		os_leaveCriticalSection();
+		os_preemptEnable();
 		return;
 	}
 
 	MemAddr addr = os_sh_writeOpen(heap, ptr);
-	os_leaveCriticalSection();
+	os_preemptEnable();
 
 	for (MemAddr i = 0; i < length; ++i) {
-		os_enterCriticalSection();
+		os_preemptDisable();
 		heap->driver->write(getFirstByteOfChunk(heap, addr) + offset + i, *(dataSrc + i));
-		os_leaveCriticalSection();
+		os_preemptEnable();
 	}
 
 	os_sh_close(heap, addr);
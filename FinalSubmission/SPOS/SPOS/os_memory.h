@@ -29,6 +29,15 @@ MemAddr os_getUseStart(Heap const* heap);
 
 MemValue os_getMapEntry(Heap const *heap, MemAddr addr);
 
+//! Map entry of the bytes following the first byte of a chunk.
+MemValue os_getMapContinuationValue(Heap const *heap);
+
+//! Map entry of a closed shared chunk, every smaller non-zero entry is a process id.
+MemValue os_getMapSharedValue(Heap const *heap);
+
+//! Share of the heap (in percent) that is used by the allocation map.
+uint8_t os_getMapOverhead(Heap const *heap);
+
 
 /*! 
  *  liefert Gr��e des Speicherbereichs in Byte zur�ck.
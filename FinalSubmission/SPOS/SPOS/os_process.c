@@ -1,4 +1,43 @@
 #include "os_process.h"
+#include "defines.h"
+
+#include <avr/pgmspace.h>
+
+#if MAX_NUMBER_OF_PROCESSES > 32
+    #error "ProcessMask only holds 32 processes"
+#endif
+
+//! Number of bits of a ProcessMask
+#define PROCESS_MASK_BITS (8 * sizeof(ProcessMask))
+
+/*!
+ *  Lookup table for the index of the lowest set bit of a byte.
+ *  The entry for 0 is INVALID_PROCESS, as there is no set bit.
+ */
+static uint8_t const PROGMEM lowestBit[256] = {
+    INVALID_PROCESS,
+                       0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    6, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    7, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    6, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0
+};
+
+//! Lookup table for the number of set bits of a nibble.
+static uint8_t const PROGMEM bitCount[16] = {
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
+};
 
 /*!
  *  Checks whether given process is runnable
@@ -13,3 +52,55 @@ bool os_isRunnable(Process const* process) {
 
     return false;
 }
+
+/*!
+ *  Finds the lowest process id inside a process mask with one table lookup per
+ *  byte of the mask (a single one for up to 8 processes).
+ *
+ *  \param mask The set of processes to search.
+ *  \return The lowest member of mask or INVALID_PROCESS if mask is empty.
+ */
+ProcessID os_firstProcessInMask(ProcessMask mask) {
+    for (uint8_t base = 0; base < PROCESS_MASK_BITS; base += 8) {
+        uint8_t const low = mask & 0xFF;
+        if (low) {
+            return base + pgm_read_byte(&lowestBit[low]);
+        }
+        mask >>= 8;
+    }
+    return INVALID_PROCESS;
+}
+
+/*!
+ *  Finds the member of a process mask that follows current in cyclic order.
+ *  The mask is rotated such that the bit after current becomes bit 0, so the
+ *  answer is a single table lookup. Current itself is returned last, i.e. if
+ *  it is the only member of the mask.
+ *
+ *  \param mask The set of processes to search.
+ *  \param current The process after which the search starts.
+ *  \return The next member of mask or INVALID_PROCESS if mask is empty.
+ */
+ProcessID os_nextProcessInMask(ProcessMask mask, ProcessID current) {
+    if (!mask) {
+        return INVALID_PROCESS;
+    }
+    uint8_t const shift = (current + 1) % PROCESS_MASK_BITS;
+    ProcessMask const rotated = (mask >> shift) | (mask << ((PROCESS_MASK_BITS - shift) % PROCESS_MASK_BITS));
+    return (os_firstProcessInMask(rotated) + shift) % PROCESS_MASK_BITS;
+}
+
+/*!
+ *  Counts the members of a process mask.
+ *
+ *  \param mask The set of processes to count.
+ *  \return The number of processes inside mask.
+ */
+uint8_t os_countProcessesInMask(ProcessMask mask) {
+    uint8_t count = 0;
+    for (uint8_t nibble = 0; nibble < PROCESS_MASK_BITS / 4; nibble++) {
+        count += pgm_read_byte(&bitCount[mask & 0x0F]);
+        mask >>= 4;
+    }
+    return count;
+}
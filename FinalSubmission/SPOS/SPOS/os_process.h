@@ -13,6 +13,9 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <avr/pgmspace.h>
+
+#include "defines.h"
 
 //! The type for the ID of a running process.
 typedef uint8_t ProcessID;
@@ -29,12 +32,27 @@ typedef uint16_t Age;
 //! The type for the checksum used to check stack consistency.
 typedef uint8_t StackChecksum;
 
+//! A set of processes. Bit i is set iff process i is a member of the set.
+#if MAX_NUMBER_OF_PROCESSES <= 8
+typedef uint8_t ProcessMask;
+#elif MAX_NUMBER_OF_PROCESSES <= 16
+typedef uint16_t ProcessMask;
+#else
+typedef uint32_t ProcessMask;
+#endif
+
+//! The member bit of process PID inside a ProcessMask.
+#define PROCESS_BIT(PID) ((ProcessMask)1 << (PID))
+
 //! Type for the state a specific process is currently in.
 typedef enum ProcessState {
 	OS_PS_UNUSED,
 	OS_PS_READY,
 	OS_PS_RUNNING,
-	OS_PS_BLOCKED
+	OS_PS_BLOCKED,
+	OS_PS_SLEEPING,
+	OS_PS_WAITING,
+	OS_PS_THROTTLED     //!< Used up its CPU budget, waits for its window to refill
 } ProcessState;
 
 //! A union that holds the current stack pointer of a given process.
@@ -52,9 +70,12 @@ typedef union StackPointer {
 typedef struct {
 	ProgramID progID;
 	ProcessState state;
-	Priority priority;
+	Priority priority;      //!< Effective priority, raised while a waiter inherits its priority
+	Priority basePriority;  //!< Priority the process was given, restored on release
 	StackPointer sp;
 	StackChecksum checksum;
+	uint16_t stackBottom;   //!< Highest address of the stack of the process
+	uint16_t stackSize;     //!< Size of the stack of the process in bytes
 } Process;
 
 //! This is the type of a program function (not the pointer to one!).
@@ -66,6 +87,30 @@ typedef enum {
 	AUTOSTART
 } OnStartDo;
 
+/*!
+ *  Everything the OS knows about a program. One of these is placed in the
+ *  flash by every PROGRAM and collected into the program table at link time.
+ */
+typedef struct {
+	Program* function;      //!< Entry point of the program
+	bool autostart;         //!< Whether a process is created at boot-up
+	uint16_t stackSize;     //!< Stack size of every process (0: STACK_SIZE_PROC)
+	Priority priority;      //!< Priority of the processes started at boot-up
+} ProgramInfo;
+
+/*!
+ *  Entry stub of a program: loads the program id into r24 and jumps to the
+ *  body. os_lookupProgramID decodes the id from the first instruction.
+ */
+#define PROGRAM_STUB_LDI_MASK  0xF0F0
+#define PROGRAM_STUB_LDI_R24   0xE080
+#define PROGRAM_STUB(INDEX, BODY) \
+    __asm__ volatile ( \
+        "ldi r24, %0" "\n\t" \
+        "jmp %x1" \
+        : : "M" (INDEX), "i" (BODY) \
+    )
+
 /*!
  *  Defines a program function with the name prog0, prog1, prog2, ...
  *  depending on the numerical index you pass as the first macro-parameter.
@@ -77,6 +122,10 @@ typedef enum {
  *  If you pass 'AUTOSTART', it will create a process for this program while
  *  initializing the scheduler. If you pass 'DONTSTART' instead, only the
  *  program will be registered (which you may execute manually).
+ *  Every process of the program gets STACK_SIZE_PROC bytes of stack and is
+ *  started with DEFAULT_PRIORITY at boot-up, see PROGRAM_EX for other values.
+ *  Nothing is registered at runtime: the program information lands in the
+ *  flash and is picked up by the program table in os_scheduler.c when linking.
  *  Use this macro in this fashion:
  *
  *    PROGRAM(3, AUTOSTART) {
@@ -85,19 +134,47 @@ typedef enum {
  *      ...
  *    }
  */
-#define PROGRAM(INDEX, ON_START_DO) \
+#define PROGRAM(INDEX, ON_START_DO) PROGRAM_EX(INDEX, ON_START_DO, 0, DEFAULT_PRIORITY)
+
+/*!
+ *  Like PROGRAM, but also sets the stack size (in bytes) of every process of
+ *  the program (0: STACK_SIZE_PROC) and the priority it is started with at
+ *  boot-up. Every field is set by name, so the order of ProgramInfo does not
+ *  matter.
+ *
+ *    PROGRAM_EX(4, DONTSTART, 96, DEFAULT_PRIORITY) {
+ *      ...
+ *    }
+ *
+ *    PROGRAM_EX(5, AUTOSTART, 0, 0xC0) {
+ *      ...
+ *    }
+ */
+#define PROGRAM_EX(INDEX, ON_START_DO, STACK, PRIO) \
     void program_with_index_##INDEX##_defined_twice (void) {} \
-    Program prog##INDEX; \
-    void registerProgram##INDEX(void) __attribute__ ((constructor)); \
-    void registerProgram##INDEX(void) { \
-        Program** os_getProgramSlot(ProgramID progId); \
-        *(os_getProgramSlot(INDEX)) = prog##INDEX; \
-        extern uint16_t os_autostart;\
-        os_autostart |= (ON_START_DO == AUTOSTART) << (INDEX); \
+    void progBody##INDEX(void); \
+    void prog##INDEX(void) __attribute__ ((naked)); \
+    void prog##INDEX(void) { \
+        PROGRAM_STUB(INDEX, progBody##INDEX); \
     } \
-    void prog##INDEX(void)
+    ProgramInfo const progInfo##INDEX PROGMEM = { \
+        .function = prog##INDEX, \
+        .autostart = (ON_START_DO == AUTOSTART), \
+        .stackSize = (STACK), \
+        .priority = (PRIO) \
+    }; \
+    void progBody##INDEX(void)
 
 //! Returns whether the passed process can be selected to run.
 bool os_isRunnable(Process const* process);
 
+//! Returns the lowest process id inside the mask (INVALID_PROCESS if empty).
+ProcessID os_firstProcessInMask(ProcessMask mask);
+
+//! Returns the first process id inside the mask that follows current (cyclic).
+ProcessID os_nextProcessInMask(ProcessMask mask, ProcessID current);
+
+//! Returns the number of processes inside the mask.
+uint8_t os_countProcessesInMask(ProcessMask mask);
+
 #endif
@@ -0,0 +1,144 @@
+#include "os_pt.h"
+#include "os_scheduler.h"
+
+//----------------------------------------------------------------------------
+// Private functions
+//----------------------------------------------------------------------------
+
+//! Appends a task to the run queue
+static void os_ptAppend(PtScheduler* scheduler, PtTask* task) {
+	task->next = NULL;
+	if (scheduler->tail) {
+		scheduler->tail->next = task;
+	} else {
+		scheduler->head = task;
+	}
+	scheduler->tail = task;
+}
+
+/*!
+ *  Inserts a task into the sleep list behind every task that wakes up
+ *  earlier or at the same time, so tasks with the same wake-up time keep
+ *  their order. Wake-up times are compared by their distance, so the list
+ *  survives the wrap-around of the system time.
+ */
+static void os_ptInsertSleeper(PtScheduler* scheduler, PtTask* task) {
+	PtTask* prev = NULL;
+	PtTask* next = scheduler->sleeping;
+	while (next && (int32_t)(next->wake - task->wake) <= 0) {
+		prev = next;
+		next = next->next;
+	}
+	task->next = next;
+	if (prev) {
+		prev->next = task;
+	} else {
+		scheduler->sleeping = task;
+	}
+}
+
+//! Moves every sleeping task whose wake-up time passed to the run queue
+static void os_ptWakeSleepers(PtScheduler* scheduler) {
+	Time const now = os_systemTime_raw();
+	PtTask* task;
+	while ((task = scheduler->sleeping) && (int32_t)(task->wake - now) <= 0) {
+		scheduler->sleeping = task->next;
+		os_ptAppend(scheduler, task);
+	}
+}
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Initializes an empty task scheduler (same as PT_SCHEDULER_INIT).
+ *
+ *  \param scheduler The task scheduler.
+ */
+void os_ptInit(PtScheduler* scheduler) {
+	scheduler->head = NULL;
+	scheduler->tail = NULL;
+	scheduler->sleeping = NULL;
+	scheduler->tasks = 0;
+}
+
+/*!
+ *  Appends a new task to the run queue. The task starts at PT_BEGIN the next
+ *  time its turn comes. The queues are not shared with other processes, so
+ *  only the process that runs os_ptRun (or one of its tasks) may spawn tasks
+ *  once os_ptRun was called.
+ *
+ *  \param scheduler The task scheduler that hosts the task.
+ *  \param task Memory for the task, it must not be spawned already.
+ *  \param function The task function.
+ *  \param arg Passed to the task in task->arg.
+ */
+void os_ptSpawn(PtScheduler* scheduler, PtTask* task, PtFunction* function, void* arg) {
+	task->function = function;
+	task->resume = 0;
+	task->arg = arg;
+	os_ptAppend(scheduler, task);
+	scheduler->tasks++;
+}
+
+/*!
+ *  Runs the tasks of a task scheduler in rounds until all of them exited.
+ *  Every round calls each task in the run queue once. Sleeping tasks are
+ *  not called until their wake-up time passed. If no task made progress in
+ *  a round, i.e. all of them only wait for conditions, the process yields,
+ *  and if every task sleeps, the process sleeps until the first wake-up
+ *  time. So the tasks take no CPU time from other processes while they have
+ *  nothing to do.
+ *
+ *  \param scheduler The task scheduler.
+ */
+void os_ptRun(PtScheduler* scheduler) {
+	while (scheduler->tasks) {
+		os_ptWakeSleepers(scheduler);
+
+		// Tasks appended during the round (again or spawned) run in the next one
+		bool progress = false;
+		PtTask* const last = scheduler->tail;
+		PtTask* task = NULL;
+		while (task != last) {
+			task = scheduler->head;
+			scheduler->head = task->next;
+			if (!scheduler->head) {
+				scheduler->tail = NULL;
+			}
+
+			switch (task->function(task)) {
+				case PT_WAITING:
+					os_ptAppend(scheduler, task);
+					break;
+				case PT_YIELDED:
+					progress = true;
+					os_ptAppend(scheduler, task);
+					break;
+				case PT_SLEEPING:
+					progress = true;
+					os_ptInsertSleeper(scheduler, task);
+					break;
+				case PT_EXITED:
+					progress = true;
+					scheduler->tasks--;
+					break;
+			}
+		}
+
+		if (progress) {
+			continue;
+		}
+		if (scheduler->head) {
+			os_yield();
+		} else if (scheduler->sleeping) {
+			Time const now = os_systemTime_raw();
+			Time const delta = scheduler->sleeping->wake - now;
+			if ((int32_t)delta > 0) {
+				// Round up, so the process does not wake up before the task
+				os_sleepMs((delta * 1000ul + TIME_RAW_PER_S - 1) / TIME_RAW_PER_S);
+			}
+		}
+	}
+}
@@ -0,0 +1,119 @@
+/*! \file
+ *  \brief Stackless cooperative tasks (protothreads) hosted by one process.
+ *
+ *  A task is a function that is called over and over by os_ptRun and
+ *  continues where it left off by means of a switch over the line number of
+ *  its last wait point. So a task needs no stack of its own, only a PtTask of
+ *  a few bytes, and any number of them share the stack of the process that
+ *  calls os_ptRun.
+ *
+ *  Local variables of a task function do not survive PT_YIELD, PT_WAIT_UNTIL
+ *  or PT_SLEEP_MS: keep the state in the PtTask (see arg) or in static
+ *  variables. A task must not use a switch statement around a wait point and
+ *  must not call blocking SPOS functions, as this stops every other task.
+ */
+
+#ifndef _OS_PT_H
+#define _OS_PT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "util.h"
+
+//----------------------------------------------------------------------------
+// Types
+//----------------------------------------------------------------------------
+
+//! What a task function tells the task scheduler when it returns
+typedef enum PtResult {
+	PT_WAITING,     //!< A condition is not met yet, the task is polled again
+	PT_YIELDED,     //!< The task made progress and wants to run again
+	PT_SLEEPING,    //!< The task waits until its wake-up time
+	PT_EXITED       //!< The task is done
+} PtResult;
+
+struct PtTask;
+
+//! This is the type of a task function (not the pointer to one!).
+typedef PtResult PtFunction(struct PtTask* task);
+
+//! A stackless task, the memory has to stay valid while the task is spawned
+typedef struct PtTask {
+	PtFunction* function;
+	struct PtTask* next;    //!< Successor in the run queue or the sleep list
+	uint16_t resume;        //!< Line of the wait point to continue at (0: start)
+	Time wake;              //!< Wake-up time (Timer 0 overflows) of a sleeping task
+	void* arg;              //!< Free for the task, e.g. a pointer to its state
+} PtTask;
+
+//! The run queue and the sleep list of the tasks hosted by one process
+typedef struct PtScheduler {
+	PtTask* head;           //!< Run queue of tasks that are ready or wait for a condition
+	PtTask* tail;
+	PtTask* sleeping;       //!< Sleeping tasks, ordered by wake-up time
+	uint16_t tasks;         //!< Number of spawned tasks that did not exit yet
+} PtScheduler;
+
+//! Static initializer for an empty task scheduler
+#define PT_SCHEDULER_INIT { .head = NULL, .tail = NULL, .sleeping = NULL, .tasks = 0 }
+
+//----------------------------------------------------------------------------
+// Task macros
+//----------------------------------------------------------------------------
+
+//! Starts the body of a task function
+#define PT_BEGIN(TASK) switch ((TASK)->resume) { case 0:
+
+//! Ends the body of a task function, the task exits
+#define PT_END(TASK) } (TASK)->resume = 0; return PT_EXITED
+
+//! Lets the other tasks run once
+#define PT_YIELD(TASK) \
+    do { \
+        (TASK)->resume = __LINE__; \
+        return PT_YIELDED; \
+        case __LINE__:; \
+    } while (0)
+
+//! Waits until the condition holds, it is checked every time the task is polled
+#define PT_WAIT_UNTIL(TASK, COND) \
+    do { \
+        (TASK)->resume = __LINE__; \
+        case __LINE__: \
+        if (!(COND)) { \
+            return PT_WAITING; \
+        } \
+    } while (0)
+
+//! Waits for at least MS milliseconds without being polled meanwhile
+#define PT_SLEEP_MS(TASK, MS) \
+    do { \
+        (TASK)->wake = os_systemTime_raw() + TIME_MS_TO_RAW(MS) + 1; \
+        (TASK)->resume = __LINE__; \
+        return PT_SLEEPING; \
+        case __LINE__:; \
+    } while (0)
+
+//! Ends the task from anywhere in its body
+#define PT_EXIT(TASK) \
+    do { \
+        (TASK)->resume = 0; \
+        return PT_EXITED; \
+    } while (0)
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! Initializes an empty task scheduler
+void os_ptInit(PtScheduler* scheduler);
+
+//! Appends a new task to the run queue, only called by the hosting process or its tasks
+void os_ptSpawn(PtScheduler* scheduler, PtTask* task, PtFunction* function, void* arg);
+
+//! Runs the tasks until all of them exited
+void os_ptRun(PtScheduler* scheduler);
+
+#endif
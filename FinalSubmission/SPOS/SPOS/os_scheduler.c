@@ -6,8 +6,13 @@
 #include "os_core.h"
 #include "lcd.h"
 #include "os_memory.h"
+#include "os_sync.h"
+#include "os_deferred.h"
 #include <avr/interrupt.h>
 #include <avr/common.h>
+#include <avr/sleep.h>
+#include <avr/pgmspace.h>
+#include <string.h>
 
 //----------------------------------------------------------------------------
 // Private Types
@@ -20,8 +25,37 @@
 //! Array of states for every possible process
 Process os_processes[MAX_NUMBER_OF_PROCESSES];
 
-//! Array of function pointers for every registered program
-Program* os_programs[MAX_NUMBER_OF_PROGRAMS];
+#if MAX_NUMBER_OF_PROGRAMS % 16 != 0 || MAX_NUMBER_OF_PROGRAMS > 64
+#error "MAX_NUMBER_OF_PROGRAMS has to be a multiple of 16 and at most 64"
+#endif
+
+#define PROGRAMS_0(X)  X(0)  X(1)  X(2)  X(3)  X(4)  X(5)  X(6)  X(7)  X(8)  X(9)  X(10) X(11) X(12) X(13) X(14) X(15)
+#define PROGRAMS_16(X) X(16) X(17) X(18) X(19) X(20) X(21) X(22) X(23) X(24) X(25) X(26) X(27) X(28) X(29) X(30) X(31)
+#define PROGRAMS_32(X) X(32) X(33) X(34) X(35) X(36) X(37) X(38) X(39) X(40) X(41) X(42) X(43) X(44) X(45) X(46) X(47)
+#define PROGRAMS_48(X) X(48) X(49) X(50) X(51) X(52) X(53) X(54) X(55) X(56) X(57) X(58) X(59) X(60) X(61) X(62) X(63)
+
+//! Every PROGRAM defines progInfo<index>, the missing ones are resolved to NULL by the linker
+#define PROGRAM_INFO_DECLARE(N) extern ProgramInfo const progInfo##N __attribute__ ((weak));
+#define PROGRAM_INFO_ENTRY(N) &progInfo##N,
+
+PROGRAMS_0(PROGRAM_INFO_DECLARE)
+PROGRAMS_16(PROGRAM_INFO_DECLARE)
+PROGRAMS_32(PROGRAM_INFO_DECLARE)
+PROGRAMS_48(PROGRAM_INFO_DECLARE)
+
+//! Program table, indexed by program id. Lives in the flash and costs no SRAM.
+ProgramInfo const* const os_programs[MAX_NUMBER_OF_PROGRAMS] PROGMEM = {
+    PROGRAMS_0(PROGRAM_INFO_ENTRY)
+#if MAX_NUMBER_OF_PROGRAMS > 16
+    PROGRAMS_16(PROGRAM_INFO_ENTRY)
+#endif
+#if MAX_NUMBER_OF_PROGRAMS > 32
+    PROGRAMS_32(PROGRAM_INFO_ENTRY)
+#endif
+#if MAX_NUMBER_OF_PROGRAMS > 48
+    PROGRAMS_48(PROGRAM_INFO_ENTRY)
+#endif
+};
 
 //! Index of process that is currently executed (default: idle)
 ProcessID currentProc = 0;
@@ -36,8 +70,80 @@ SchedulingStrategy schedulingStrategy;
 //! Count of currently nested critical sections
 uint8_t criticalSectionCount = 0;
 
-//! Used to auto-execute programs.
-uint16_t os_autostart;
+//! Processes that can be selected by a scheduling strategy (state READY or RUNNING).
+ProcessMask os_readyMask = 0;
+
+//! Free process slots (state UNUSED), os_exec takes the lowest one.
+ProcessMask os_unusedMask = 0;
+
+//! Processes that yielded and have to sit out one scheduling decision (state BLOCKED).
+ProcessMask os_blockedMask = 0;
+
+//! First process of the delta list of sleeping processes (the one that wakes up next).
+ProcessID sleepHead = INVALID_PROCESS;
+
+//! Successor of each sleeping process in the delta list.
+ProcessID sleepNext[MAX_NUMBER_OF_PROCESSES];
+
+//! Raw time (Timer 0 overflows) each sleeping process waits after its predecessor woke up.
+Time sleepDelta[MAX_NUMBER_OF_PROCESSES];
+
+//! Raw time up to which the head of the delta list has been advanced.
+Time sleepLastUpdate = 0;
+
+//! Release and deadline bookkeeping of periodic processes.
+PeriodicInfo periodicInfo[MAX_NUMBER_OF_PROCESSES];
+
+//! CPU accounting and scheduling latency of every process.
+ProcessStats processStats[MAX_NUMBER_OF_PROCESSES];
+
+//! Time (Timer 0 ticks) the running process got the CPU.
+Time statsDispatchTime = 0;
+
+//! Time (Timer 0 ticks) the statistics were reset the last time.
+Time statsResetTime = 0;
+
+//! CPU budget of every process.
+CpuBudget cpuBudgets[MAX_NUMBER_OF_PROCESSES];
+
+//! Processes that used up their CPU budget (state THROTTLED).
+ProcessMask os_throttledMask = 0;
+
+//! Number of scheduler interrupts so far, the clock of the CPU budgets.
+uint16_t schedulerTicks = 0;
+
+//! Clock select bits (CS22..CS20) of the scheduler timer for the regular tick.
+uint8_t tickClockSelect;
+
+//! Compare value of the scheduler timer for the regular tick.
+uint8_t tickCompare;
+
+//! Period of the regular tick in us.
+uint16_t tickPeriod;
+
+//! Number of ticks a process runs before each strategy is asked again.
+uint8_t strategyQuantum[SCHEDULING_STRATEGY_COUNT] = { [0 ... SCHEDULING_STRATEGY_COUNT - 1] = SCHEDULER_QUANTUM };
+
+//! Ticks left until the strategy decides again.
+uint8_t quantumLeft = SCHEDULER_QUANTUM;
+
+//! Currently active stack integrity mode
+StackIntegrityMode stackIntegrityMode = STACK_INTEGRITY_MODE;
+
+//! Processes whose stored checksum describes their suspended stack.
+ProcessMask stackChecksumValid = 0;
+
+//! Counts suspended stacks in mode OS_SI_SAMPLED.
+uint8_t stackSampleCounter = 0;
+
+//! Number of bytes restoreContext pops from the stack: 32 registers and SREG.
+#define INITIAL_FRAME_SIZE 33
+
+//! Register frame of a new process in memory order (r0 to r30, SREG, r31), copied by os_exec.
+static uint8_t const initialFrame[INITIAL_FRAME_SIZE] PROGMEM = { 0 };
+
+//! XOR of all bytes of initialFrame, calculated by os_initScheduler.
+StackChecksum initialFrameChecksum = 0;
 
 //----------------------------------------------------------------------------
 // Private function declarations
@@ -46,6 +152,54 @@ uint16_t os_autostart;
 //! ISR for timer compare match (scheduler)
 ISR(TIMER2_COMPA_vect) __attribute__((naked));
 
+//! Stretches or restores the scheduler tick depending on whether only the idle process can run
+static void os_updateTickMode(void);
+
+//! Wakes up all sleeping processes whose deadline has passed
+static void os_wakeSleepers(void);
+
+//! Puts the current process into the delta list of sleeping processes and suspends it
+static void os_sleepRaw(Time delta);
+
+//! Records the start of a job of the current (periodic) process
+static void os_startJob(void);
+
+//! Finishes the job of the current process and waits for the next release
+static bool os_finishJob(void);
+
+//! Chooses the next process and prepares it for being restored (runs on the scheduler stack)
+static void os_selectNextProcess(void);
+
+//! Makes the processes that sat out a scheduling decision ready again
+static void os_readyBlocked(void);
+
+//! Adds the time since its dispatch to the CPU time of the process that is suspended
+static void os_chargeCurrent(void);
+
+//! Charges a scheduler tick to the budget of a process and tells whether it is used up
+static bool os_chargeBudget(ProcessID pid);
+
+//! Makes throttled processes whose window is over ready again
+static void os_refillBudgets(void);
+
+//! Context switch for processes that give up the CPU voluntarily
+static void os_switchVoluntary(void) __attribute__((naked, noinline));
+
+//! Records what is needed to check the stack of a process that was just suspended
+static void os_sealStack(ProcessID pid);
+
+//! Checks the stack of a process that is about to be resumed
+static void os_verifyStack(ProcessID pid);
+
+//! Writes the canary bytes to the limit of the stack of a process
+static void os_writeStackCanary(ProcessID pid);
+
+//! Finds room for a stack of the passed size in the stack region
+static uint16_t os_allocStack(uint16_t size);
+
+//! Returns the lowest address of the stack of a process
+static uint16_t os_getStackLimit(ProcessID pid);
+
 //----------------------------------------------------------------------------
 // Function definitions
 //----------------------------------------------------------------------------
@@ -70,27 +224,85 @@ ISR(TIMER2_COMPA_vect) {
 	//Stackpointers des aktuellen Prozesses sichern //step 3
 	os_processes[currentProc].sp.as_int = SP;
 	
-	//nach dem Setzen des Stackpointers auf den Scheduler-Stack die Prüfsumme des Prozessstacks des unterbrochenen Prozesses ermittelt und abspeichert.
-	os_processes[currentProc].checksum = os_getStackChecksum(currentProc);
-
 	//Stackpointer auf den Scheduler-Stack setzen//step 4
 	SP = BOTTOM_OF_ISR_STACK;
 
+	//nach dem Setzen des Stackpointers auf den Scheduler-Stack die Prüfsumme des Prozessstacks des unterbrochenen Prozesses ermittelt und abspeichert.
+	os_sealStack(currentProc);
+
+	MEASURE_START(tickStart);
+	os_chargeCurrent();
+	schedulerTicks++;
+	os_refillBudgets();
 	
-	if (os_processes[currentProc].state == OS_PS_RUNNING) {
-		os_processes[currentProc].state = OS_PS_READY;
-	} else if (os_processes[currentProc].state != OS_PS_UNUSED && os_processes[currentProc].state != OS_PS_BLOCKED) {
+	// A process that used up its budget is skipped by every strategy until its window is over
+	bool const wasRunning = os_processes[currentProc].state == OS_PS_RUNNING;
+	if (wasRunning) {
+		os_setProcessState(currentProc, os_chargeBudget(currentProc) ? OS_PS_THROTTLED : OS_PS_READY);
+	} else if (os_processes[currentProc].state == OS_PS_READY) {
 		os_error("ass err unexpectprog state :-(");
 	}
 
 
-   
-   os_initInput();
-   if((os_getInput() & 0b00001001) == 0b00001001){
-	   os_waitForNoInput();
-	   os_taskManOpen();
-   }
-   
+	// ENTER + ESC wird vom Pin-Change-Interrupt gelatcht
+	bool taskMan = false;
+	if (os_hotkeyLatched && os_hotkeyConfirmed()) {
+		os_waitForNoInput();
+		os_taskManMain();
+		os_clearHotkey();
+		taskMan = true;
+	}
+
+	// Work that interrupt handlers deferred, processes it makes ready take part in the decision
+	ProcessMask const readyBefore = os_readyMask;
+	os_runDeferred();
+
+	// Solange das Quantum nicht aufgebraucht ist, wird die Strategie nicht gefragt
+	bool keep = wasRunning && !taskMan && --quantumLeft && currentProc != 0 && os_processes[currentProc].state == OS_PS_READY;
+	if (keep) {
+		// The quantum only delays the strategy, sleepers and yielders are made ready on every tick
+		os_wakeSleepers();
+		os_readyBlocked();
+		// A job released or woken meanwhile may have an earlier deadline
+		if (schedulingStrategy == OS_SS_EDF && (os_readyMask & ~readyBefore)) {
+			keep = false;
+		}
+	}
+	if (keep) {
+		os_setProcessState(currentProc, OS_PS_RUNNING);
+		os_verifyStack(currentProc);
+	} else {
+		// Only a switch to another process counts as preemption
+		ProcessID const previous = currentProc;
+		os_selectNextProcess();
+		if (wasRunning && currentProc != previous) {
+			processStats[previous].preemptions++;
+		}
+	}
+	
+	// The task manager would spoil the statistics
+	if (!taskMan) {
+		MEASURE_END(OS_MC_TICK, tickStart);
+	}
+	
+    //Stackpointer wiederherstellen//step 8
+	SP = os_processes[currentProc].sp.as_int;
+	
+	//step 9 & 10
+	restoreContext();
+}
+
+/*!
+ *  The part of the scheduler that is shared between the timer interrupt and
+ *  the voluntary context switch. It has to run on the scheduler stack, after the
+ *  context of the previous process was saved. It lets the active strategy pick
+ *  the next process, marks it as running and verifies its stack.
+ */
+static void os_selectNextProcess(void) {
+	MEASURE_START(dispatchStart);
+	
+	// Sleeping processes whose deadline passed take part in this decision
+	os_wakeSleepers();
    
     //Scheduling-Strategie fuer naechsten Prozess auswaehlen//step 6
 	switch (os_getSchedulingStrategy()) {
@@ -112,54 +324,169 @@ ISR(TIMER2_COMPA_vect) {
 		case OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE:
 			currentProc = os_Scheduler_MLFQ(os_processes, currentProc);
 			break;
+		case OS_SS_EDF:
+			currentProc = os_Scheduler_EDF(os_processes, currentProc);
+			break;
+		case OS_SS_STRIDE:
+			currentProc = os_Scheduler_Stride(os_processes, currentProc);
+			break;
 	}
 	
 	// BLOCKED prozesse sollen mindestens einmal aussetzen. Das haben sie nach dem switch gemacht.
-	for (uint8_t i = 0; i < MAX_NUMBER_OF_PROCESSES; ++i) {
-		if (os_processes[i].state == OS_PS_BLOCKED) {
-			os_processes[i].state = OS_PS_READY;
-		}
-	}
+	os_readyBlocked();
 	
     //Fortzusetzender Prozesszustand auf OS_PS_RUNNING setzen//step 7
-	os_processes[currentProc].state = OS_PS_RUNNING;
+	os_setProcessState(currentProc, OS_PS_RUNNING);
 	
-    // Pruefen, ob die Stack Checksumme immer noch passt
-	if (os_processes[currentProc].checksum != os_getStackChecksum(currentProc)) {
-		os_error(" INVALID  STACK     CHECKSUM");
+	// Time from ready to running. The CPU time of the process is counted from here on.
+	Time const now = os_systemTime_augment();
+	ProcessStats* stats = &processStats[currentProc];
+	Time const latency = now - stats->readySince;
+	stats->dispatches++;
+	stats->latencySum += latency;
+	if (latency > stats->maxLatency) {
+		stats->maxLatency = latency > UINT16_MAX ? UINT16_MAX : latency;
 	}
+	statsDispatchTime = now;
+	quantumLeft = strategyQuantum[schedulingStrategy];
+	
+	// Nobody but the idle process wants the CPU -> no need for the regular tick
+	os_updateTickMode();
+	
+    // Pruefen, ob der Stack noch intakt ist
+	os_verifyStack(currentProc);
+	
+	MEASURE_END(OS_MC_DISPATCH, dispatchStart);
+}
+
+/*!
+ *  Makes every BLOCKED process ready again. Only the members of the blocked
+ *  mask are touched, not the whole process array.
+ */
+static void os_readyBlocked(void) {
+	ProcessMask blocked = os_blockedMask;
+	if (!blocked) {
+		return;
+	}
+	os_blockedMask = 0;
+	os_readyMask |= blocked;
+	Time const now = os_systemTime_augment();
+	while (blocked) {
+		ProcessID const pid = os_firstProcessInMask(blocked);
+		os_processes[pid].state = OS_PS_READY;
+		processStats[pid].readySince = now;
+		os_mlfqEnqueue(pid);
+		blocked &= blocked - 1;
+	}
+}
+
+/*!
+ *  Fast context switch for os_yield and the other functions that suspend the
+ *  current process on its own request. Unlike the timer interrupt, only the
+ *  registers that a called function has to preserve are saved, and neither the
+ *  process state nor the task manager hotkey has to be looked at.
+ *  The frame is compatible with restoreContext, so a process suspended here can
+ *  be resumed by the timer interrupt and vice versa.
+ *  Must be called with interrupts disabled and the state of the current process
+ *  already changed.
+ */
+static void os_switchVoluntary(void) {
+	saveCalleeSavedContext();
+	
+	os_processes[currentProc].sp.as_int = SP;
+	SP = BOTTOM_OF_ISR_STACK;
+	
+	// Not before, its call frame would land in the free part of the process stack
+	os_sealStack(currentProc);
+	
+	MEASURE_START(switchStart);
+	os_chargeCurrent();
+	os_runDeferred();
+	os_selectNextProcess();
+	MEASURE_END(OS_MC_SWITCH, switchStart);
 	
-    //Stackpointer wiederherstellen//step 8
 	SP = os_processes[currentProc].sp.as_int;
 	
-	//step 9 & 10
 	restoreContext();
 }
 
 /*!
- *  Used to register a function as program. On success the program is written to
- *  the first free slot within the os_programs array (if the program is not yet
- *  registered) and the index is returned. On failure, INVALID_PROGRAM is returned.
- *  Note, that this function is not used to register the idle program.
+ *  Adds the time since the last dispatch to the CPU time of the current
+ *  process. Called by both context switches right after the context was saved,
+ *  so neither the task manager nor the scheduling decision is charged to any
+ *  process.
+ */
+static void os_chargeCurrent(void) {
+	Time const now = os_systemTime_augment();
+	processStats[currentProc].cpuTime += now - statsDispatchTime;
+	statsDispatchTime = now;
+}
+
+/*!
+ *  Charges the scheduler tick that interrupted a process to its CPU budget.
+ *  The budget is counted in whole ticks: a process that gives up the CPU
+ *  before the tick is not charged, just like the quantum.
  *
- *  \param program The function you want to register.
- *  \return The index of the newly registered program.
+ *  \param pid The process that was running when the tick came.
+ *  \return True if the process used up its budget for the current window.
  */
-ProgramID os_registerProgram(Program* program) {
-    ProgramID slot = 0;
+static bool os_chargeBudget(ProcessID pid) {
+	CpuBudget* budget = &cpuBudgets[pid];
+	if (!budget->ticks) {
+		return false;
+	}
+	if ((uint16_t)(schedulerTicks - budget->windowStart) >= budget->window) {
+		budget->windowStart = schedulerTicks;
+		budget->used = 0;
+	}
+	if (++budget->used < budget->ticks) {
+		return false;
+	}
+	budget->throttles++;
+	return true;
+}
 
-    // Find first free place to put our program
-    while (os_programs[slot] &&
-           os_programs[slot] != program && slot < MAX_NUMBER_OF_PROGRAMS) {
-        slot++;
-    }
+/*!
+ *  Starts a new window for every throttled process whose window is over and
+ *  makes it ready again. Only the members of the throttled mask are visited.
+ */
+static void os_refillBudgets(void) {
+	ProcessMask throttled = os_throttledMask;
+	while (throttled) {
+		ProcessID const pid = os_firstProcessInMask(throttled);
+		throttled &= throttled - 1;
+		CpuBudget* budget = &cpuBudgets[pid];
+		if ((uint16_t)(schedulerTicks - budget->windowStart) >= budget->window) {
+			budget->windowStart = schedulerTicks;
+			budget->used = 0;
+			os_setProcessState(pid, OS_PS_READY);
+		}
+	}
+}
 
-    if (slot >= MAX_NUMBER_OF_PROGRAMS) {
-        return INVALID_PROGRAM;
+/*!
+ *  Looks up the flash information of a program.
+ *
+ *  \param programID The program in question.
+ *  \return The flash address of the information, or NULL if there is no such program.
+ */
+ProgramInfo const* os_lookupProgramInfo(ProgramID programID) {
+    if (programID >= MAX_NUMBER_OF_PROGRAMS) {
+        return NULL;
     }
+    return (ProgramInfo const*)pgm_read_word(&os_programs[programID]);
+}
 
-    os_programs[slot] = program;
-    return slot;
+/*!
+ *  Programs are registered when linking (see PROGRAM), so this function only
+ *  checks whether the passed function is a program and returns its index.
+ *  On failure, INVALID_PROGRAM is returned.
+ *
+ *  \param program The function you want to register.
+ *  \return The index of the program.
+ */
+ProgramID os_registerProgram(Program* program) {
+    return os_lookupProgramID(program);
 }
 
 /*!
@@ -170,17 +497,197 @@ ProgramID os_registerProgram(Program* program) {
  *  \return True if the program with the specified ID is to be auto started.
  */
 bool os_checkAutostartProgram(ProgramID programID) {
-    return !!(os_autostart & (1 << programID));
+    ProgramInfo const* info = os_lookupProgramInfo(programID);
+    return info && pgm_read_byte(&info->autostart);
+}
+
+/*!
+ *  Returns the priority a program is started with at boot-up.
+ *
+ *  \param programID The program in question.
+ *  \return The priority given to the PROGRAM macro or DEFAULT_PRIORITY.
+ */
+Priority os_getProgramPriority(ProgramID programID) {
+    ProgramInfo const* info = os_lookupProgramInfo(programID);
+    return info ? pgm_read_byte(&info->priority) : DEFAULT_PRIORITY;
+}
+
+//! Clock select bits of the scheduler timer
+#define TICK_CLOCK_SELECT_MASK ((1 << CS22) | (1 << CS21) | (1 << CS20))
+
+//! Clock select bits of the scheduler timer for prescaler 1024
+#define TICK_CLOCK_SELECT_1024 ((1 << CS22) | (1 << CS21) | (1 << CS20))
+
+/*!
+ *  Programs prescaler and compare value of the scheduler timer. The counter is
+ *  restarted when one of them changes, so the first tick after the change has
+ *  full length even if the counter already passed the new compare value.
+ *  A stopped timer (e.g. by a test task that calls the scheduler on its own)
+ *  stays stopped.
+ *
+ *  \param clockSelect The new clock select bits (CS22..CS20).
+ *  \param compare The new value for OCR2A.
+ */
+static void os_setTickTimer(uint8_t clockSelect, uint8_t compare) {
+	uint8_t const running = TCCR2B & TICK_CLOCK_SELECT_MASK;
+	if (running && (running != clockSelect || OCR2A != compare)) {
+		TCCR2B = (TCCR2B & ~TICK_CLOCK_SELECT_MASK) | clockSelect;
+		OCR2A = compare;
+		TCNT2 = 0;
+	}
+}
+
+/*!
+ *  Sets the period of the scheduler tick. Timer 2 has the prescalers 1, 8, 32,
+ *  64, 128, 256 and 1024; the smallest one that still reaches the period is
+ *  taken, as it gives the finest resolution. Starts the scheduler timer.
+ *
+ *  \param us The period in us, from SCHEDULER_TICK_MIN_US up to ~13 ms.
+ *  \return True if the period could be set.
+ */
+bool os_setTickPeriod(uint16_t us) {
+	// log2 of the prescaler for each clock select value 1..7
+	static uint8_t const prescalerShift[] = { 0, 3, 5, 6, 7, 8, 10 };
+	
+	if (us < SCHEDULER_TICK_MIN_US) {
+		return false;
+	}
+	uint32_t const cycles = (uint32_t)us * (F_CPU / 1000000ul);
+	for (uint8_t cs = 1; cs <= sizeof(prescalerShift); cs++) {
+		uint8_t const shift = prescalerShift[cs - 1];
+		uint32_t const counts = (cycles + (1ul << shift >> 1)) >> shift;
+		if (counts <= 256) {
+			os_enterCriticalSection();
+			tickClockSelect = cs;
+			tickCompare = counts - 1;
+			tickPeriod = us;
+			TCCR2B = (TCCR2B & ~TICK_CLOCK_SELECT_MASK) | cs;
+			OCR2A = tickCompare;
+			TCNT2 = 0;
+			os_leaveCriticalSection();
+			return true;
+		}
+	}
+	return false;
+}
+
+//! Returns the period of the scheduler tick in us.
+uint16_t os_getTickPeriod(void) {
+	return tickPeriod;
+}
+
+/*!
+ *  Sets the number of ticks a process may run before the passed strategy is
+ *  asked for the next process. Blocking, yielding or terminating ends the
+ *  quantum early. Strategies that count time slices (Round Robin, MLFQ) count
+ *  quanta then. Sleepers are still woken on every tick, and under EDF a
+ *  process that became ready ends the quantum as well.
+ *
+ *  \param strategy The strategy the quantum applies to.
+ *  \param ticks The length of the quantum in ticks (at least 1).
+ */
+void os_setStrategyQuantum(SchedulingStrategy strategy, uint8_t ticks) {
+	if (strategy < SCHEDULING_STRATEGY_COUNT && ticks) {
+		strategyQuantum[strategy] = ticks;
+	}
+}
+
+//! Returns the number of ticks of the quantum of a strategy.
+uint8_t os_getStrategyQuantum(SchedulingStrategy strategy) {
+	return strategy < SCHEDULING_STRATEGY_COUNT ? strategyQuantum[strategy] : 0;
+}
+
+/*!
+ *  Tickless idle. As long as the idle process is the only runnable process
+ *  and no deferred procedure waits, the scheduler tick is stretched up to the
+ *  next sleeper's wakeup, at most to the longest period Timer 2 supports
+ *  (~13 ms). As soon as another process is runnable the regular tick is
+ *  restored. Wakeups the delta list does not know of (interrupt handlers that
+ *  post a semaphore or deferred work) call os_restoreTick, so they wait for
+ *  at most one regular tick instead of the rest of the stretched one.
+ *  The system time is kept by Timer 0, which keeps running while the CPU
+ *  sleeps in SLEEP_MODE_IDLE.
+ */
+static void os_updateTickMode(void) {
+	// Throttled processes need the regular tick to get their budget back, deferred work the next decision
+	if (currentProc == 0 && os_readyMask == PROCESS_BIT(0) && !os_throttledMask && !os_getDeferredPending()) {
+		// One Timer 0 overflow takes 64 Timer 2 counts at prescaler 1024. Wake up in time for the next sleeper.
+		if (sleepHead != INVALID_PROCESS && sleepDelta[sleepHead] < (SCHEDULER_IDLE_COMPARE + 1ul) / 64) {
+			if (sleepDelta[sleepHead]) {
+				os_setTickTimer(TICK_CLOCK_SELECT_1024, sleepDelta[sleepHead] * 64 - 1);
+			} else {
+				os_setTickTimer(tickClockSelect, tickCompare);
+			}
+		} else {
+			os_setTickTimer(TICK_CLOCK_SELECT_1024, SCHEDULER_IDLE_COMPARE);
+		}
+	} else {
+		os_setTickTimer(tickClockSelect, tickCompare);
+	}
+}
+
+/*!
+ *  Switches a stretched idle tick back to the regular period. The timer is
+ *  restarted, so the next decision follows after at most one regular tick.
+ *  Nothing changes while the regular tick runs. Has to be called with
+ *  interrupts disabled, e.g. from an interrupt handler.
+ */
+void os_restoreTick(void) {
+	os_setTickTimer(tickClockSelect, tickCompare);
+}
+
+/*!
+ *  Advances the delta list of sleeping processes to the current raw time.
+ *  Only the head of the list carries the time that is left, the others only
+ *  store the difference to their predecessor. Hence the scheduler only has to
+ *  look at the head on every tick, no matter how many processes sleep.
+ *  Every process whose deadline passed is made ready again.
+ */
+static void os_wakeSleepers(void) {
+	Time const now = os_systemTime_raw();
+	Time elapsed = now - sleepLastUpdate;
+	sleepLastUpdate = now;
+	
+	while (sleepHead != INVALID_PROCESS && sleepDelta[sleepHead] <= elapsed) {
+		ProcessID const pid = sleepHead;
+		elapsed -= sleepDelta[pid];
+		sleepHead = sleepNext[pid];
+		os_setProcessState(pid, OS_PS_READY);
+	}
+	if (sleepHead != INVALID_PROCESS) {
+		sleepDelta[sleepHead] -= elapsed;
+	}
+}
+
+/*!
+ *  Removes a process from the delta list of sleeping processes. The time it
+ *  had left is handed to its successor, so all other deadlines stay the same.
+ *
+ *  \param pid The process to remove. Nothing happens if it does not sleep.
+ */
+static void os_removeSleeper(ProcessID pid) {
+	ProcessID* link = &sleepHead;
+	while (*link != INVALID_PROCESS && *link != pid) {
+		link = &sleepNext[*link];
+	}
+	if (*link == INVALID_PROCESS) {
+		return;
+	}
+	*link = sleepNext[pid];
+	if (*link != INVALID_PROCESS) {
+		sleepDelta[*link] += sleepDelta[pid];
+	}
 }
 
 /*!
  *  This is the idle program. The idle process owns all the memory
  *  and processor time no other process wants to have.
+ *  It puts the CPU to sleep until the next interrupt instead of spinning.
  */
-PROGRAM(0, AUTOSTART) {
-    while(1){
-		lcd_writeString(".");
-		delayMs(DEFAULT_OUTPUT_DELAY);
+PROGRAM_EX(0, AUTOSTART, STACK_SIZE_IDLE, DEFAULT_PRIORITY) {
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	while(1){
+		sleep_mode();
 	}
 }
 
@@ -191,32 +698,40 @@ PROGRAM(0, AUTOSTART) {
  * \return The pointer to the according function, or NULL if programID is invalid.
  */
 Program* os_lookupProgramFunction(ProgramID programID) {
-    // Return NULL if the index is out of range
-    if (programID >= MAX_NUMBER_OF_PROGRAMS) {
+    // Return NULL if the index is out of range or nobody defined the program
+    ProgramInfo const* info = os_lookupProgramInfo(programID);
+    if (!info) {
         return NULL;
     }
 
-    return os_programs[programID];
+    return (Program*)pgm_read_word(&info->function);
 }
 
 /*!
  * Lookup the id of a program.
+ * Every program starts with "ldi r24, <id>" (see PROGRAM_STUB), so the id is
+ * decoded from the first instruction and confirmed with the program table.
  *
  * \param program The function of the program you want to look up.
  * \return The id to the according slot, or INVALID_PROGRAM if program is invalid.
  */
 ProgramID os_lookupProgramID(Program* program) {
-    ProgramID i;
+    if (!program) {
+        return INVALID_PROGRAM;
+    }
 
-    // Search program array for a match
-    for (i = 0; i < MAX_NUMBER_OF_PROGRAMS; i++) {
-        if (os_programs[i] == program) {
-            return i;
-        }
+    // function pointers are word addresses
+    uint16_t const opcode = pgm_read_word((uint16_t)program * 2);
+    if ((opcode & PROGRAM_STUB_LDI_MASK) != PROGRAM_STUB_LDI_R24) {
+        return INVALID_PROGRAM;
     }
+    ProgramID const id = ((opcode >> 4) & 0xF0) | (opcode & 0x0F);
 
-    // If no match was found return INVALID_PROGRAM
-    return INVALID_PROGRAM;
+    // Any other function may start with the same instruction
+    if (os_lookupProgramFunction(id) != program) {
+        return INVALID_PROGRAM;
+    }
+    return id;
 }
 
 /*!
@@ -239,19 +754,10 @@ ProgramID os_lookupProgramID(Program* program) {
 ProcessID os_exec(ProgramID programID, Priority priority) {
 	//we dont want an interrupt here, so enter critical section
 	os_enterCriticalSection();
-	
-    int8_t freeIndex = -1;
 
-	//Nach neuem Platz im Array suchen, bis eines gefunden wurde
-	for(uint8_t i = 0; i < MAX_NUMBER_OF_PROCESSES; i++){
-		if(os_processes[i].state == OS_PS_UNUSED){
-			freeIndex = i;
-			break;
-		}
-	}
-
-	// If freeIndex -1 then no free place in  array found and we can return INVALID_PROCESS
-	if(freeIndex == -1){
+	// Lowest free slot from the bitmap instead of searching the array
+	ProcessID const freeIndex = os_firstProcessInMask(os_unusedMask);
+	if(freeIndex == INVALID_PROCESS){
 		os_leaveCriticalSection();
 		return INVALID_PROCESS;	//Rage quit
 	}
@@ -262,39 +768,46 @@ ProcessID os_exec(ProgramID programID, Priority priority) {
 			return INVALID_PROCESS;	
 	}
 
-	//Prozess in den Prozess-Array eintragen
+	uint16_t stackSize = os_getProgramStackSize(programID);
+	uint16_t stackBottom = os_allocStack(stackSize);
+	if(stackBottom == 0){
+		os_leaveCriticalSection();
+		return INVALID_PROCESS;
+	}
+
+	//Prozess in den Prozess-Array eintragen (noch nicht READY, der Stack fehlt)
 	Process* newProcess = &os_processes[freeIndex];
-	newProcess->state = OS_PS_READY;//here newProcess is a point, so has to use ->
+	processStats[freeIndex] = (ProcessStats){ 0 };
+	cpuBudgets[freeIndex] = (CpuBudget){ 0 };
 	newProcess->progID = programID;
 	newProcess->priority = priority;
-	newProcess->sp.as_int = PROCESS_STACK_BOTTOM(freeIndex);
-
-	
-	// funktionszeiger (Typ: void) -> uint16_t
-	uint16_t ptrFktZeiger = (uint16_t) &os_dispatcher;
-	
-	//the address of PC register(Programmzaehler)is 16 bits.
-	uint8_t bytesDesFunktionsregisters[2];
-	bytesDesFunktionsregisters[0] = ptrFktZeiger >> 8;
-	// move the higher 8 bits to the lower position, and the uint8_t then takes the lower 8 bits
-	bytesDesFunktionsregisters[1] = ptrFktZeiger & 0x00FF;	// LOW  Bytes
-	//uint8_t automatically abandon the higher 8 bits //can I just: uint8_t low_byte = (uint16_t)currentProgramPointer?
-
-
-	*(newProcess->sp.as_ptr) = bytesDesFunktionsregisters[1];	// LOW  Bytes
-	newProcess->sp.as_int--;
-	*(newProcess->sp.as_ptr) = bytesDesFunktionsregisters[0];  // HIGH Bytes
-	newProcess->sp.as_int--;
-	
-	//Da alle Register mit 0 inizialisiert werden sollen, k�nnen wir 33x 8-Bit mit 0en f�llen
-	for(uint8_t i = 0; i < 33; i++){
-		*(newProcess->sp.as_ptr) = 0b00000000;//all set as 0b00000000
-		newProcess->sp.as_int--;// Dekrement stackpointer // alternative: set by PROCESS_STACK_BOTTOM(PID)
+	newProcess->basePriority = priority;
+	newProcess->stackBottom = stackBottom;
+	newProcess->stackSize = stackSize;
+
+	// Mark the whole stack as unused, so the high-water mark can be found later
+	memset((void*)(stackBottom - stackSize + 1), STACK_FILL_PATTERN, stackSize);
+
+	// Return address (os_dispatcher) above the register frame, high byte below the low byte
+	uint16_t const ptrFktZeiger = (uint16_t) &os_dispatcher;
+	uint8_t* const frame = (uint8_t*)stackBottom;
+	frame[0] = ptrFktZeiger & 0x00FF;	// LOW  Bytes
+	frame[-1] = ptrFktZeiger >> 8;		// HIGH Bytes
+
+	// Registers and SREG as restoreContext expects them, copied in one go
+	newProcess->sp.as_int = stackBottom - 2 - INITIAL_FRAME_SIZE;
+	memcpy_P(newProcess->sp.as_ptr + 1, initialFrame, INITIAL_FRAME_SIZE);
+
+	os_writeStackCanary(freeIndex);
+	// The checksum of the fresh stack is known: return address, template and the byte at sp
+	if (stackIntegrityMode == OS_SI_CHECKSUM || stackIntegrityMode == OS_SI_SAMPLED) {
+		newProcess->checksum = (ptrFktZeiger & 0x00FF) ^ (ptrFktZeiger >> 8) ^ initialFrameChecksum ^ STACK_FILL_PATTERN;
+		stackChecksumValid |= PROCESS_BIT(freeIndex);
 	}
-	
-	newProcess->checksum = os_getStackChecksum(freeIndex);
-	//set age of process to 0 and leave critical section
+
+	// Level, pass and age for the new process, it is queued once it becomes READY
 	os_resetProcessSchedulingInformation(freeIndex);
+	os_setProcessState(freeIndex, OS_PS_READY);
 
 	os_leaveCriticalSection();
 	
@@ -310,7 +823,7 @@ void os_startScheduler(void) {
 	//1. Setzen der Variable für den aktuellen Prozess auf 0 (Leerlaufprozess)
     currentProc = 0;
 	//2. Den Zustand des Leerlaufprozesses auf OS_PS_RUNNING ändern
-	os_processes[0].state = OS_PS_RUNNING;
+	os_setProcessState(0, OS_PS_RUNNING);
 	//3. Setzen des Stackpointers auf den Prozessstack des Leerlaufprozesses
 	SP = os_processes[0].sp.as_int;
 	//4. Sprung in den Leerlaufprozess mit restoreContext()
@@ -322,8 +835,14 @@ void os_startScheduler(void) {
  *  initialize its internal data-structures and register.
  */
 void os_initScheduler(void) {
+	// os_exec does not have to calculate the checksum of every new stack
+	for (uint8_t i = 0; i < INITIAL_FRAME_SIZE; i++) {
+		initialFrameChecksum ^= pgm_read_byte(&initialFrame[i]);
+	}
+	// the MLFQ levels are maintained by os_setProcessState from now on
+	os_initSchedulingInformation();
     for(uint8_t i = 0; i < MAX_NUMBER_OF_PROCESSES; i++){
-		os_processes[i].state = OS_PS_UNUSED;
+		os_setProcessState(i, OS_PS_UNUSED);
 	}
 	
 	for(uint8_t progID = 0; progID < MAX_NUMBER_OF_PROGRAMS; progID++){
@@ -333,7 +852,7 @@ void os_initScheduler(void) {
 		}
 		
 		if(os_checkAutostartProgram(progID)){
-			os_exec(progID, DEFAULT_PRIORITY);
+			os_exec(progID, os_getProgramPriority(progID));
 		}
 	}
 }
@@ -349,13 +868,65 @@ Process* os_getProcessSlot(ProcessID pid) {
 }
 
 /*!
- *  A simple getter for the slot of a specific program.
+ *  Changes the state of a process and keeps the ready and blocked masks in
+ *  sync with it. Every state transition has to go through this function, as
+ *  the scheduling strategies only look at the masks.
  *
- *  \param programID The ProgramID of the process to be handled
- *  \return A pointer to the function pointer of the program at position programID in the os_programs array.
+ *  \param pid The process whose state changes.
+ *  \param state The new state of the process.
  */
-Program** os_getProgramSlot(ProgramID programID) {
-    return os_programs + programID;
+void os_setProcessState(ProcessID pid, ProcessState state) {
+	ProcessMask const bit = PROCESS_BIT(pid);
+	bool const wasReady = os_readyMask & bit;
+	os_processes[pid].state = state;
+	os_unusedMask &= ~bit;
+	os_throttledMask &= ~bit;
+	switch (state) {
+		case OS_PS_READY:
+			// start of the scheduling latency
+			processStats[pid].readySince = os_systemTime_augment();
+			// e.g. woken by an interrupt handler while the idle tick is stretched
+			if (!wasReady && pid != 0) {
+				os_restoreTick();
+			}
+			// fall through
+		case OS_PS_RUNNING:
+			os_readyMask |= bit;
+			os_blockedMask &= ~bit;
+			if (!wasReady) {
+				os_mlfqEnqueue(pid);
+			}
+			return;
+		case OS_PS_BLOCKED:
+			os_readyMask &= ~bit;
+			os_blockedMask |= bit;
+			break;
+		case OS_PS_THROTTLED:
+			os_throttledMask |= bit;
+			os_readyMask &= ~bit;
+			os_blockedMask &= ~bit;
+			break;
+		case OS_PS_UNUSED:
+			os_unusedMask |= bit;
+			// fall through
+		default:
+			os_readyMask &= ~bit;
+			os_blockedMask &= ~bit;
+			break;
+	}
+	// the MLFQ levels only hold processes that can run
+	if (wasReady) {
+		os_removeFromMlfq(pid);
+	}
+}
+
+/*!
+ *  A simple getter for the set of processes a scheduling strategy may choose from.
+ *
+ *  \return The mask of all processes in state READY or RUNNING.
+ */
+ProcessMask os_getReadyMask(void) {
+    return os_readyMask;
 }
 
 /*!
@@ -390,8 +961,8 @@ uint8_t os_getNumberOfActiveProcs(void) {
  */
 uint8_t os_getNumberOfRegisteredPrograms(void) {
     uint8_t count = 0;
-    for (ProcessID i = 0; i < MAX_NUMBER_OF_PROGRAMS; i++)
-        if (*(os_getProgramSlot(i))) count++;
+    for (ProgramID i = 0; i < MAX_NUMBER_OF_PROGRAMS; i++)
+        if (os_lookupProgramInfo(i)) count++;
     // Note that this only works because programs cannot be unregistered.
     return count;
 }
@@ -416,32 +987,40 @@ SchedulingStrategy os_getSchedulingStrategy(void) {
     return schedulingStrategy;
 }
 
+/*!
+ *  Sets the way the scheduler checks stacks on a context switch. Checksums
+ *  stored under a previous mode are discarded, so the first resume of every
+ *  process after the change is not checked.
+ *
+ *  \param mode The stack integrity mode that is to be used from now on.
+ */
+void os_setStackIntegrityMode(StackIntegrityMode mode) {
+	os_enterCriticalSection();
+	stackIntegrityMode = mode;
+	stackChecksumValid = 0;
+	stackSampleCounter = 0;
+	os_leaveCriticalSection();
+}
+
+/*!
+ *  This is a getter for retrieving the current stack integrity mode.
+ *
+ *  \return The current stack integrity mode.
+ */
+StackIntegrityMode os_getStackIntegrityMode(void) {
+	return stackIntegrityMode;
+}
+
 /*!
  *  Enters a critical code section by disabling the scheduler if needed.
  *  This function stores the nesting depth of critical sections of the current
  *  process (e.g. if a function with a critical section is called from another
  *  critical section) to ensure correct behavior when leaving the section.
  *  This function supports up to 255 nested critical sections.
+ *  Interrupts are not disabled, see os_preemptDisable.
  */
 void os_enterCriticalSection(void) {
-    
-    //1.save current interrupt state
-	uint8_t localGIEB = SREG & 0b10000000;
-	
-	//2.disable interrupt,
-	SREG &= 0b01111111;
-	
-	if (criticalSectionCount == 255) {
-		os_error("critical section count overflow");
-	}
-	//3.increment critical section count
-	criticalSectionCount++;
-	
-	//4.deactivate scheduler
-	TIMSK2 &= 0b11111101;
-	
-	//5.apply old state
-	SREG |= localGIEB;
+	os_preemptDisable();
 }
 
 /*!
@@ -451,28 +1030,155 @@ void os_enterCriticalSection(void) {
  *  has to be reactivated.
  */
 void os_leaveCriticalSection(void) {
-	
-    if(criticalSectionCount <= 0){
-		os_error("leaveCritSec count error");
-		return;
+	os_preemptEnable();
+}
+
+/*!
+ *  Called with the stack pointer of a suspended process already saved. Depending
+ *  on the stack integrity mode, the checksum of the stack is stored, so
+ *  os_verifyStack can compare it when the process is resumed.
+ *
+ *  \param pid The process that was suspended.
+ */
+static void os_sealStack(ProcessID pid) {
+	switch (stackIntegrityMode) {
+		case OS_SI_SAMPLED:
+			if (++stackSampleCounter < STACK_INTEGRITY_SAMPLE_INTERVAL) {
+				stackChecksumValid &= ~PROCESS_BIT(pid);
+				break;
+			}
+			stackSampleCounter = 0;
+			// fall through
+		case OS_SI_CHECKSUM:
+			os_processes[pid].checksum = os_getStackChecksum(pid);
+			stackChecksumValid |= PROCESS_BIT(pid);
+			break;
+		default:
+			break;
 	}
-	
-    //save current interrupt state
-	uint8_t localGIEB = SREG & 0b10000000;
-	
-	//disable interrupt
-	SREG &= 0b01111111;
-	//decrement critical section count
-	criticalSectionCount--;
-	
-	//check if critical section count is zero / if were no longer in the critical section
-	if(criticalSectionCount == 0){
-		//activate scheduler
-		TIMSK2 |= 0b00000010;
+}
+
+/*!
+ *  Checks the stack of a process before it gets resumed and raises an error if
+ *  it was changed. The checksum modes only compare checksums that os_sealStack
+ *  stored. The canary mode costs constant time: it checks the canary bytes at
+ *  the stack limit and that the saved stack pointer lies above them.
+ *
+ *  \param pid The process that is about to be resumed.
+ */
+static void os_verifyStack(ProcessID pid) {
+	switch (stackIntegrityMode) {
+		case OS_SI_CHECKSUM:
+		case OS_SI_SAMPLED:
+			if ((stackChecksumValid & PROCESS_BIT(pid)) && os_processes[pid].checksum != os_getStackChecksum(pid)) {
+				os_error(" INVALID  STACK     CHECKSUM");
+			}
+			break;
+		case OS_SI_CANARY: {
+			uint8_t const* canary = (uint8_t const*)os_getStackLimit(pid);
+			for (uint8_t i = 0; i < STACK_CANARY_SIZE; i++) {
+				if (canary[i] != STACK_CANARY_VALUE) {
+					os_error(" STACK CANARY   OVERWRITTEN");
+				}
+			}
+			if (os_processes[pid].sp.as_int < os_getStackLimit(pid) + STACK_CANARY_SIZE - 1) {
+				os_error(" STACK POINTER  OUT OF BOUNDS");
+			}
+			break;
+		}
+		default:
+			break;
 	}
-	
-	//apply old state
-	SREG |= localGIEB;
+}
+
+/*!
+ *  Fills the lowest bytes of the stack of a process with the canary value. This
+ *  is done for every new process regardless of the current mode, so the canary
+ *  mode can be switched on at any time.
+ *
+ *  \param pid The process whose stack gets the canary.
+ */
+static void os_writeStackCanary(ProcessID pid) {
+	uint8_t* canary = (uint8_t*)os_getStackLimit(pid);
+	for (uint8_t i = 0; i < STACK_CANARY_SIZE; i++) {
+		canary[i] = STACK_CANARY_VALUE;
+	}
+}
+
+/*!
+ *  Returns the lowest address that belongs to the stack of a process.
+ *
+ *  \param pid The process whose stack is meant.
+ *  \return The address of the stack limit, where the canary is placed.
+ */
+static uint16_t os_getStackLimit(ProcessID pid) {
+	return os_processes[pid].stackBottom - os_processes[pid].stackSize + 1;
+}
+
+/*!
+ *  Looks for a part of the stack region that is not used by the stack of any
+ *  process and is big enough for a new stack. Stacks are placed as high as
+ *  possible, so the free part of the region stays at its lower end.
+ *  Must be called inside a critical section.
+ *
+ *  \param size The size of the new stack in bytes.
+ *  \return The highest address of the new stack or 0 if there is no room.
+ */
+static uint16_t os_allocStack(uint16_t size) {
+	uint16_t bottom = BOTTOM_OF_PROCS_STACK;
+	uint8_t pid = 0;
+	while (pid < MAX_NUMBER_OF_PROCESSES) {
+		if (bottom < STACK_REGION_LIMIT + size - 1) {
+			return 0;
+		}
+		if (os_processes[pid].state != OS_PS_UNUSED
+				&& os_processes[pid].stackBottom >= bottom - size + 1
+				&& os_getStackLimit(pid) <= bottom) {
+			// Overlaps with that stack, try right below it and check all stacks again
+			bottom = os_getStackLimit(pid) - 1;
+			pid = 0;
+			continue;
+		}
+		pid++;
+	}
+	return bottom;
+}
+
+/*!
+ *  Returns the size of the stack a process of the passed program gets. This is
+ *  the size given to the PROGRAM macro or STACK_SIZE_PROC, but at least
+ *  STACK_SIZE_MIN.
+ *
+ *  \param programID The program in question.
+ *  \return The stack size in bytes.
+ */
+uint16_t os_getProgramStackSize(ProgramID programID) {
+	ProgramInfo const* info = os_lookupProgramInfo(programID);
+	uint16_t size = info ? pgm_read_word(&info->stackSize) : 0;
+	if (size == 0) {
+		return STACK_SIZE_PROC;
+	}
+	return size < STACK_SIZE_MIN ? STACK_SIZE_MIN : size;
+}
+
+/*!
+ *  Finds out how deep the stack of a process has grown since it was started.
+ *  os_exec fills every new stack with STACK_FILL_PATTERN, so the first byte
+ *  above the canary that differs from the pattern marks the deepest point.
+ *
+ *  \param pid The process in question.
+ *  \return The number of stack bytes used at most (0 for unused slots).
+ */
+uint16_t os_getStackHighWater(ProcessID pid) {
+	if (pid >= MAX_NUMBER_OF_PROCESSES || os_processes[pid].state == OS_PS_UNUSED) {
+		return 0;
+	}
+	uint16_t bottom = os_processes[pid].stackBottom;
+	uint16_t addr = os_getStackLimit(pid) + STACK_CANARY_SIZE;
+	while (addr <= bottom && *((uint8_t const*)addr) == STACK_FILL_PATTERN) {
+		addr++;
+	}
+	return bottom - addr + 1;
 }
 
 /*!
@@ -485,7 +1191,7 @@ StackChecksum os_getStackChecksum(ProcessID pid) {
 	StackPointer underBound;
 
 	//set it to bottom of process stack
-	underBound.as_int = PROCESS_STACK_BOTTOM(pid);
+	underBound.as_int = os_processes[pid].stackBottom;
 	StackPointer stackPointer = os_processes[pid].sp;
 	//create new stack pointer to iterate through stack
 
@@ -508,7 +1214,13 @@ void os_dispatcher() {//调度
 	}
 
 	ProgramID progID = os_processes[currentProc].progID;
-	os_programs[progID]();//run the newProc
+	if (periodicInfo[currentProc].period != 0) {
+		os_startJob();
+	}
+	// Periodic processes run the program once per release
+	do {
+		os_lookupProgramFunction(progID)();//run the newProc
+	} while (os_finishJob());
 
 	os_kill(currentProc);//kill the currentProc
 
@@ -528,9 +1240,15 @@ bool os_kill(ProcessID pid) {
 	}
 
 
-	os_processes[pid].state = OS_PS_UNUSED;
+	if (os_processes[pid].state == OS_PS_SLEEPING) {
+		os_removeSleeper(pid);
+	}
+	os_syncCleanup(pid);
+	periodicInfo[pid].period = 0;
+	os_setProcessState(pid, OS_PS_UNUSED);
 	os_processes[pid].progID = 0;
 	os_processes[pid].priority = 0;
+	os_processes[pid].basePriority = 0;
 	os_processes[pid].sp.as_int = 0;
 
 	//we have tested the os_freeProcessMemory is still not so efficient,
@@ -538,7 +1256,6 @@ bool os_kill(ProcessID pid) {
 	//os_freeProcessMemory(intHeap,pid);
 	
 	os_resetProcessSchedulingInformation(pid);
-	os_removeFromMlfq(pid);
 	
 	for (uint8_t i = 0; i < os_getHeapListLength() ; i++) {
 		os_freeProcessMemory(os_lookupHeap(i), pid);
@@ -556,29 +1273,322 @@ bool os_kill(ProcessID pid) {
 }
 
 
-void os_yield() {
+/*!
+ *  Gives up the processor for the current process. The current process is put
+ *  into the passed state and the scheduler is invoked directly. This works
+ *  from within critical sections: their nesting depth is stored for the
+ *  process and restored once it runs again.
+ *  For states other than OS_PS_BLOCKED, some other part of the kernel has to
+ *  make the process READY again.
+ *
+ *  \param state The state the process waits in (e.g. OS_PS_BLOCKED).
+ */
+void os_suspendCurrent(ProcessState state) {
 
 	os_enterCriticalSection();
 
 	uint8_t currentCritSecLvl = criticalSectionCount;
 	criticalSectionCount = 0;
+#if OS_MEASURE
+	// The section ends here for the measurement, other processes run meanwhile
+	os_measureRecord(OS_MC_PREEMPT_OFF, os_measureNow() - measurePreemptStart);
+#endif
 	
 	
 	uint8_t GIEB = SREG & 0b10000000;//GIEB=0bX00000000
 	
 	SREG &= 0b01111111;//SREG=0b0XXXXXXXX;
 	
-	os_processes[currentProc].state = OS_PS_BLOCKED;
+	os_setProcessState(currentProc, state);
 	
 	TIMSK2 |= 0b00000010;
 	
-	TIMER2_COMPA_vect();
+	os_switchVoluntary();
 	
 	TIMSK2 &= 0b11111101;
 	
 	criticalSectionCount = currentCritSecLvl;
+#if OS_MEASURE
+	measurePreemptStart = os_measureNow();
+#endif
 
 	SREG = GIEB | (SREG & 0b0111111);//SREG=0bYXXXXXXXX; GIEB=0bX00000000 right now
 	
 	os_leaveCriticalSection();
-}
\ No newline at end of file
+}
+
+void os_yield() {
+	os_suspendCurrent(OS_PS_BLOCKED);
+}
+
+/*!
+ *  Suspends the current process for at least the given time. In contrast to
+ *  delayMs the process is taken out of the ready set, so the CPU goes to other
+ *  processes in the meantime. The process is inserted into a delta list which
+ *  the scheduler advances on every tick.
+ *  The resolution is one Timer 0 overflow (~3.3 ms). Times longer than
+ *  TIME_MS_TO_RAW_MAX (~3.9 h) are cut to it, as their conversion would wrap.
+ *  The idle process and code that runs before the scheduler is started cannot
+ *  sleep, they wait actively.
+ *
+ *  \param ms The time to sleep in milliseconds.
+ */
+void os_sleepMs(Time ms) {
+	if (ms == 0) {
+		return;
+	}
+	if (ms > TIME_MS_TO_RAW_MAX) {
+		ms = TIME_MS_TO_RAW_MAX;
+	}
+	if (currentProc == 0) {
+		delayMs(ms);
+		return;
+	}
+
+	os_enterCriticalSection();
+	
+	// bring the list up to date, so the delta of the head is relative to now
+	os_wakeSleepers();
+	
+	// +1 as the current overflow period has already begun
+	os_sleepRaw(TIME_MS_TO_RAW(ms) + 1);
+	
+	os_leaveCriticalSection();
+}
+
+/*!
+ *  Inserts the current process into the delta list, so it wakes up delta
+ *  Timer 0 overflows after the last update of the list, and suspends it.
+ *  Processes with the same wake-up time stay in FIFO order.
+ *  Must be called inside a critical section right after os_wakeSleepers.
+ *
+ *  \param delta The time to sleep in Timer 0 overflows.
+ */
+static void os_sleepRaw(Time delta) {
+	ProcessID* link = &sleepHead;
+	while (*link != INVALID_PROCESS && sleepDelta[*link] <= delta) {
+		delta -= sleepDelta[*link];
+		link = &sleepNext[*link];
+	}
+	if (*link != INVALID_PROCESS) {
+		sleepDelta[*link] -= delta;
+	}
+	sleepDelta[currentProc] = delta;
+	sleepNext[currentProc] = *link;
+	*link = currentProc;
+	
+	os_suspendCurrent(OS_PS_SLEEPING);
+}
+
+/*!
+ *  Creates a process that runs the passed program once per period. Every run
+ *  is a job that is released at the start of its period and has to finish
+ *  within relativeDeadline. When the program function returns, the job is
+ *  finished and the process sleeps until the next release. With OS_SS_EDF,
+ *  the job with the earliest deadline runs first.
+ *  Both times are stored as 16 bit raw times, so they must not exceed
+ *  UINT16_MAX Timer 0 overflows (about 214 s).
+ *
+ *  \param programID The program to run periodically.
+ *  \param period The time between two releases in ms.
+ *  \param relativeDeadline The time after its release by which a job has to finish in ms (0: the period).
+ *  \return The ID of the new process or INVALID_PROCESS.
+ */
+ProcessID os_execPeriodic(ProgramID programID, Time period, Time relativeDeadline) {
+	if (relativeDeadline == 0) {
+		relativeDeadline = period;
+	}
+	// Checked in ms, as TIME_MS_TO_RAW wraps for large values
+	if (period == 0 || period > UINT16_MAX * 1000ul / TIME_RAW_PER_S || relativeDeadline > UINT16_MAX * 1000ul / TIME_RAW_PER_S) {
+		return INVALID_PROCESS;
+	}
+	Time const periodRaw = TIME_MS_TO_RAW(period);
+	Time const deadlineRaw = TIME_MS_TO_RAW(relativeDeadline);
+
+	// The process must not start before it knows that it is periodic
+	os_enterCriticalSection();
+	ProcessID pid = os_exec(programID, DEFAULT_PRIORITY);
+	if (pid != INVALID_PROCESS) {
+		PeriodicInfo* info = &periodicInfo[pid];
+		info->period = periodRaw;
+		info->relDeadline = deadlineRaw;
+		info->release = os_systemTime_raw();
+		info->deadline = info->release + deadlineRaw;
+		info->jobs = 0;
+		info->misses = 0;
+		info->minLatency = UINT16_MAX;
+		info->maxLatency = 0;
+	}
+	os_leaveCriticalSection();
+	return pid;
+}
+
+/*!
+ *  Updates the latency statistics when a job of the current process starts.
+ */
+static void os_startJob(void) {
+	PeriodicInfo* info = &periodicInfo[currentProc];
+	Time latency = os_systemTime_raw() - info->release;
+	if (latency > UINT16_MAX) {
+		latency = UINT16_MAX;
+	}
+	if (latency < info->minLatency) {
+		info->minLatency = latency;
+	}
+	if (latency > info->maxLatency) {
+		info->maxLatency = latency;
+	}
+}
+
+/*!
+ *  Called by the dispatcher when the program function returns. For periodic
+ *  processes, the finished job is checked against its deadline, the next job
+ *  is released and the process sleeps until then. Releases whose deadline has
+ *  already passed are skipped and count as misses.
+ *
+ *  \return True if the program is to be run again for the next job.
+ */
+static bool os_finishJob(void) {
+	PeriodicInfo* info = &periodicInfo[currentProc];
+	if (info->period == 0) {
+		return false;
+	}
+
+	os_enterCriticalSection();
+	os_wakeSleepers();
+	// the delta list is up to date until exactly this point in time
+	Time const now = sleepLastUpdate;
+	info->jobs++;
+	if (now > info->deadline) {
+		info->misses++;
+	}
+	info->release += info->period;
+	while (info->release + info->relDeadline < now) {
+		info->release += info->period;
+		info->jobs++;
+		info->misses++;
+	}
+	info->deadline = info->release + info->relDeadline;
+	if (info->release > now) {
+		os_sleepRaw(info->release - now);
+	}
+	os_leaveCriticalSection();
+
+	os_startJob();
+	return true;
+}
+
+/*!
+ *  \param pid The process in question.
+ *  \return The release and deadline bookkeeping of the process (period 0 if it is not periodic).
+ */
+PeriodicInfo const* os_getPeriodicInfo(ProcessID pid) {
+	return &periodicInfo[pid];
+}
+
+/*!
+ *  Used by the EDF strategy to order processes.
+ *
+ *  \param pid The process in question.
+ *  \return The absolute deadline of the current job in Timer 0 overflows, the
+ *          maximum time for processes that are not periodic.
+ */
+Time os_getDeadline(ProcessID pid) {
+	if (periodicInfo[pid].period == 0) {
+		return UINT32_MAX;
+	}
+	return periodicInfo[pid].deadline;
+}
+
+/*!
+ *  Returns the CPU accounting and scheduling latency of a process since it was
+ *  started or the statistics were reset. All times are in Timer 0 ticks.
+ *
+ *  \param pid The process to look at.
+ *  \return The statistics of the process.
+ */
+ProcessStats const* os_getProcessStats(ProcessID pid) {
+	return &processStats[pid];
+}
+
+/*!
+ *  Calculates the share of the CPU a process got since the statistics were
+ *  reset. For the running process, its current time slice is included.
+ *
+ *  \param pid The process to look at.
+ *  \return The CPU load of the process in percent.
+ */
+uint8_t os_getCpuLoad(ProcessID pid) {
+	os_enterCriticalSection();
+	Time const now = os_systemTime_augment();
+	Time cpuTime = processStats[pid].cpuTime;
+	if (pid == currentProc) {
+		cpuTime += now - statsDispatchTime;
+	}
+	Time const window = (now - statsResetTime) / 100;
+	os_leaveCriticalSection();
+	
+	if (window == 0) {
+		return 0;
+	}
+	Time const load = cpuTime / window;
+	return load > 100 ? 100 : load;
+}
+
+/*!
+ *  Clears the CPU accounting and scheduling latency of all processes, so the
+ *  CPU load is measured from now on.
+ */
+void os_resetProcessStats(void) {
+	os_enterCriticalSection();
+	Time const now = os_systemTime_augment();
+	for (ProcessID pid = 0; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+		ProcessStats* stats = &processStats[pid];
+		stats->cpuTime = 0;
+		stats->latencySum = 0;
+		stats->dispatches = 0;
+		stats->preemptions = 0;
+		stats->maxLatency = 0;
+	}
+	statsResetTime = now;
+	statsDispatchTime = now;
+	os_leaveCriticalSection();
+}
+
+/*!
+ *  Limits the CPU time of a process to at most ticks scheduler ticks per
+ *  window of window ticks. A process that used up its budget is put into the
+ *  state OS_PS_THROTTLED by the scheduler interrupt and skipped by every
+ *  strategy until its window is over. The budget starts with a fresh window.
+ *
+ *  \param pid The process to limit (not the idle process).
+ *  \param ticks Ticks per window, 0 removes the limit.
+ *  \param window Length of the window in scheduler ticks.
+ *  \return False if the process or the budget is invalid.
+ */
+bool os_setCpuBudget(ProcessID pid, uint16_t ticks, uint16_t window) {
+	if (pid == 0 || pid >= MAX_NUMBER_OF_PROCESSES || (ticks && ticks > window)) {
+		return false;
+	}
+	os_enterCriticalSection();
+	CpuBudget* budget = &cpuBudgets[pid];
+	budget->ticks = ticks;
+	budget->window = window;
+	budget->used = 0;
+	budget->windowStart = schedulerTicks;
+	if (os_processes[pid].state == OS_PS_THROTTLED) {
+		os_setProcessState(pid, OS_PS_READY);
+	}
+	os_leaveCriticalSection();
+	return true;
+}
+
+/*!
+ *  Returns the CPU budget of a process and how often it used it up.
+ *
+ *  \param pid The process to look at.
+ *  \return The budget of the process.
+ */
+CpuBudget const* os_getCpuBudget(ProcessID pid) {
+	return &cpuBudgets[pid];
+}
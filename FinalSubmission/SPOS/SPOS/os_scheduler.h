@@ -14,7 +14,10 @@
 #include <stdbool.h>
 
 #include "defines.h"
+#include "os_core.h"
 #include "os_process.h"
+#include "util.h"
+#include "os_measure.h"
 
 //----------------------------------------------------------------------------
 // Types
@@ -27,21 +30,76 @@ typedef enum SchedulingStrategy {
 	OS_SS_RUN_TO_COMPLETION,
 	OS_SS_ROUND_ROBIN,
 	OS_SS_INACTIVE_AGING,
-	OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE
+	OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE,
+	OS_SS_EDF,
+	OS_SS_STRIDE
 } SchedulingStrategy;
 
 // Change this define to reflect the number of available strategies:
-#define SCHEDULING_STRATEGY_COUNT 6
+#define SCHEDULING_STRATEGY_COUNT 8
+
+//! Job release and deadline bookkeeping of a periodic process (times in Timer 0 overflows)
+typedef struct PeriodicInfo {
+	uint16_t period;        //!< 0 for processes that are not periodic
+	uint16_t relDeadline;
+	Time release;           //!< Release time of the current job
+	Time deadline;          //!< Absolute deadline of the current job
+	uint16_t jobs;          //!< Number of finished (or skipped) jobs
+	uint16_t misses;        //!< Number of jobs that finished late or were skipped
+	uint16_t minLatency;    //!< Shortest time from release to job start
+	uint16_t maxLatency;    //!< Longest time from release to job start
+} PeriodicInfo;
+
+//! CPU accounting and scheduling latency of a process (times in Timer 0 ticks, ~13 us)
+typedef struct ProcessStats {
+	Time cpuTime;           //!< Time the process held the CPU
+	Time readySince;        //!< When the process became ready the last time
+	Time latencySum;        //!< Sum of all times from ready to running
+	uint16_t dispatches;    //!< Number of times the process got the CPU
+	uint16_t preemptions;   //!< Number of times the timer interrupt took the CPU away
+	uint16_t maxLatency;    //!< Longest time from ready to running
+} ProcessStats;
+
+//! CPU budget of a process: at most ticks scheduler ticks per window of window ticks
+typedef struct CpuBudget {
+	uint16_t ticks;         //!< 0 for processes without a budget
+	uint16_t window;
+	uint16_t used;          //!< Ticks charged in the current window
+	uint16_t windowStart;   //!< Scheduler tick the current window started at
+	uint16_t throttles;     //!< Number of times the process used up its budget
+} CpuBudget;
+
+//! How the scheduler checks the stack of a process before resuming it
+typedef enum StackIntegrityMode {
+	OS_SI_OFF,          //!< No check at all
+	OS_SI_CHECKSUM,     //!< XOR over the whole used stack on every switch
+	OS_SI_CANARY,       //!< Canary bytes at the stack limit and a bounds check of the stack pointer
+	OS_SI_SAMPLED       //!< Like OS_SI_CHECKSUM, but only every STACK_INTEGRITY_SAMPLE_INTERVAL-th switch
+} StackIntegrityMode;
+
+#define STACK_INTEGRITY_MODE_COUNT 4
 
 //! Get a pointer to the process structure by process ID
 Process* os_getProcessSlot(ProcessID pid);
 
+//! Changes the state of a process and updates the ready/blocked masks
+void os_setProcessState(ProcessID pid, ProcessState state);
+
+//! Returns the set of processes that are READY or RUNNING
+ProcessMask os_getReadyMask(void);
+
 //! Starts the scheduler
 void os_startScheduler(void);
 
 //! Registers a program (will not be started)
 ProgramID os_registerProgram(Program* program);
 
+//! Looks up the flash information of a program and returns NULL on failure
+ProgramInfo const* os_lookupProgramInfo(ProgramID programID);
+
+//! Returns the priority a program is started with at boot-up
+Priority os_getProgramPriority(ProgramID programID);
+
 //! Checks if a program is to be executed at boot-time
 bool os_checkAutostartProgram(ProgramID programID);
 
@@ -54,6 +112,30 @@ ProgramID os_lookupProgramID(Program* program);
 //! Executes a process by instantiating a program
 ProcessID os_exec(ProgramID programID, Priority priority);
 
+//! Executes a process that runs the program once per period (both times in ms, deadline 0: the period)
+ProcessID os_execPeriodic(ProgramID programID, Time period, Time relativeDeadline);
+
+//! Returns the release and deadline bookkeeping of a process
+PeriodicInfo const* os_getPeriodicInfo(ProcessID pid);
+
+//! Returns the absolute deadline of the current job of a process (maximum time for non-periodic ones)
+Time os_getDeadline(ProcessID pid);
+
+//! Returns the CPU accounting and scheduling latency of a process
+ProcessStats const* os_getProcessStats(ProcessID pid);
+
+//! Returns the share of the CPU a process got since the statistics were reset (in percent)
+uint8_t os_getCpuLoad(ProcessID pid);
+
+//! Clears the CPU accounting and scheduling latency of all processes
+void os_resetProcessStats(void);
+
+//! Limits a process to ticks scheduler ticks per window (ticks 0 removes the limit)
+bool os_setCpuBudget(ProcessID pid, uint16_t ticks, uint16_t window);
+
+//! Returns the CPU budget of a process and how often it was throttled
+CpuBudget const* os_getCpuBudget(ProcessID pid);
+
 //! Returns the number of programs
 uint8_t os_getNumberOfRegisteredPrograms(void);
 
@@ -75,12 +157,79 @@ SchedulingStrategy os_getSchedulingStrategy(void);
 //! Calculates the checksum of the stack for the corresponding process of pid.
 StackChecksum os_getStackChecksum(ProcessID pid);
 
+//! Returns the stack size processes of the passed program get
+uint16_t os_getProgramStackSize(ProgramID programID);
+
+//! Returns the maximum number of stack bytes the process has used so far
+uint16_t os_getStackHighWater(ProcessID pid);
+
+//! Sets the period of the scheduler tick in us (prescaler and compare value are derived)
+bool os_setTickPeriod(uint16_t us);
+
+//! Returns the period of the scheduler tick in us
+uint16_t os_getTickPeriod(void);
+
+//! Ends a stretched idle tick, the next tick follows after at most one regular period
+void os_restoreTick(void);
+
+//! Sets the number of ticks a process runs before the strategy decides again
+void os_setStrategyQuantum(SchedulingStrategy strategy, uint8_t ticks);
+
+//! Returns the number of ticks of the quantum of a strategy
+uint8_t os_getStrategyQuantum(SchedulingStrategy strategy);
+
+//! Sets how stacks are checked on a context switch
+void os_setStackIntegrityMode(StackIntegrityMode mode);
+
+//! Gets the current stack integrity mode
+StackIntegrityMode os_getStackIntegrityMode(void);
+
 //! Enters a critical code section
 void os_enterCriticalSection(void);
 
 //! Leaves a critical code section
 void os_leaveCriticalSection(void);
 
+//! Nesting depth of the sections the scheduler is disabled in
+extern uint8_t criticalSectionCount;
+
+/*!
+ *  Keeps the scheduler from switching to another process until the matching
+ *  os_preemptEnable. Interrupts stay enabled, so this is the primitive for
+ *  kernel data structures that no interrupt handler touches. The tick is masked
+ *  before the count is raised, so a tick in between is a regular switch.
+ *  Nests up to 255 times, deeper nesting is an error.
+ */
+static inline void os_preemptDisable(void) {
+	if (criticalSectionCount == 255) {
+		os_error("critical section count overflow");
+		return;
+	}
+	TIMSK2 &= ~(1 << OCIE2A);
+	__asm__ volatile ("" ::: "memory");
+#if OS_MEASURE
+	if (criticalSectionCount == 0) {
+		measurePreemptStart = os_measureNow();
+	}
+#endif
+	criticalSectionCount++;
+}
+
+//! Allows preemption again once every os_preemptDisable was matched, an unmatched call is an error
+static inline void os_preemptEnable(void) {
+	__asm__ volatile ("" ::: "memory");
+	if (criticalSectionCount == 0) {
+		os_error("leaveCritSec count error");
+		return;
+	}
+	if (--criticalSectionCount == 0) {
+#if OS_MEASURE
+		os_measureRecord(OS_MC_PREEMPT_OFF, os_measureNow() - measurePreemptStart);
+#endif
+		TIMSK2 |= (1 << OCIE2A);
+	}
+}
+
 /*!
  * \brief Kills a process by cleaning up the corresponding slot in os_processes. It also calls the garbage collection in order to free any memory that has been allocated by the killed process.
  *
@@ -98,4 +247,10 @@ void os_dispatcher();
 
 void os_yield();
 
+//! Gives up the CPU, leaving the current process in the passed state until it is made READY again
+void os_suspendCurrent(ProcessState state);
+
+//! Suspends the current process for at least ms milliseconds without using the CPU
+void os_sleepMs(Time ms);
+
 #endif
@@ -4,61 +4,136 @@
 
 SchedulingInformation schedulingInfo;//global Variable
 
-//Initializes the given ProcessQueue with a predefined size. 
-void pqueue_init(ProcessQueue* queue) {
-	queue->size = MAX_NUMBER_OF_PROCESSES;
-	queue->head = 0;
-	queue->tail = 0;
-	for (int i = 0; i < 8; ++i) {
-		queue->data[i] = 0;
-	}
+//! Number of scheduling decisions between two MLFQ boosts (0 disables the boost)
+static uint16_t mlfqBoostInterval = MLFQ_BOOST_INTERVAL;
+
+/*!
+ *  The MLFQ levels only hold processes that can run (READY or RUNNING). A
+ *  process leaves its level when it blocks, sleeps, waits or terminates, and is
+ *  appended to the end of the level again once it is ready. os_setProcessState
+ *  keeps the lists up to date, so every operation on them takes constant time.
+ */
+
+//! Returns the first process in an MLFQ level (INVALID_PROCESS if empty).
+ProcessID MLFQ_getFirst(uint8_t level) {
+	return schedulingInfo.mlfq_head[level];
 }
 
-//Resets the given ProcessQueue. 
-void pqueue_reset(ProcessQueue* queue) {
-	queue->head = 0;
-	queue->tail = 0;
+//! Returns the successor of a process in its MLFQ level (INVALID_PROCESS at the end).
+ProcessID MLFQ_getNext(ProcessID pid) {
+	return schedulingInfo.mlfq_next[pid];
 }
 
-//Checks whether there is next a ProcessID.
-uint8_t pqueue_hasNext(ProcessQueue* queue) {
-	return queue->head != queue->tail;
+//! Appends a process to the end of the passed level.
+static void mlfq_append(ProcessID pid, uint8_t level) {
+	ProcessID const tail = schedulingInfo.mlfq_tail[level];
+	schedulingInfo.mlfq_level[pid] = level;
+	schedulingInfo.mlfq_prev[pid] = tail;
+	schedulingInfo.mlfq_next[pid] = INVALID_PROCESS;
+	if (tail == INVALID_PROCESS) {
+		schedulingInfo.mlfq_head[level] = pid;
+	} else {
+		schedulingInfo.mlfq_next[tail] = pid;
+	}
+	schedulingInfo.mlfq_tail[level] = pid;
+	schedulingInfo.mlfq_nonEmpty |= 1 << level;
+	schedulingInfo.mlfq_queued |= PROCESS_BIT(pid);
 }
 
-//Returns the first ProcessID of the given ProcessQueue.
-ProcessID pqueue_getFirst(ProcessQueue* queue) {
-	return queue->data[queue->head];
+//! Unlinks a queued process from its level.
+static void mlfq_unlink(ProcessID pid) {
+	uint8_t const level = schedulingInfo.mlfq_level[pid];
+	ProcessID const prev = schedulingInfo.mlfq_prev[pid];
+	ProcessID const next = schedulingInfo.mlfq_next[pid];
+	if (prev == INVALID_PROCESS) {
+		schedulingInfo.mlfq_head[level] = next;
+	} else {
+		schedulingInfo.mlfq_next[prev] = next;
+	}
+	if (next == INVALID_PROCESS) {
+		schedulingInfo.mlfq_tail[level] = prev;
+	} else {
+		schedulingInfo.mlfq_prev[next] = prev;
+	}
+	if (schedulingInfo.mlfq_head[level] == INVALID_PROCESS) {
+		schedulingInfo.mlfq_nonEmpty &= ~(1 << level);
+	}
+	schedulingInfo.mlfq_queued &= ~PROCESS_BIT(pid);
 }
 
-//Drops the first ProcessID of the given ProcessQueue.
-void pqueue_dropFirst(ProcessQueue* queue) {
-	queue->data[queue->head] = 0;
-	queue->head = (queue->head + 1) % queue->size;
+//! Level a process with the passed priority starts in.
+static uint8_t mlfq_levelOf(Priority priority) {
+	return MLFQ_LEVELS - 1 - (priority >> 6);
 }
 
-//Appends a ProcessID to the given ProcessQueue.
-void pqueue_append(ProcessQueue* queue, ProcessID pid) {
-	queue->data[queue->tail] = pid;
-	queue->tail = (queue->tail + 1) % queue->size;
+/*!
+ *  Called when a process becomes ready. It is appended to the level it was in
+ *  before, keeping what is left of its time slice.
+ *
+ *  \param id The process that became ready.
+ */
+void os_mlfqEnqueue(ProcessID id) {
+	if (id == 0 || (schedulingInfo.mlfq_queued & PROCESS_BIT(id))) {
+		return;
+	}
+	mlfq_append(id, schedulingInfo.mlfq_level[id]);
 }
 
-//Returns the corresponding ProcessQueue.
-ProcessQueue* MLFQ_getQueue(uint8_t queueID) {
-	return &schedulingInfo.qs[queueID];
+/*!
+ *  Called when a process is no longer ready.
+ *
+ *  \param id The process that blocked, sleeps, waits or terminated.
+ */
+void os_removeFromMlfq(ProcessID id) {
+	if (schedulingInfo.mlfq_queued & PROCESS_BIT(id)) {
+		mlfq_unlink(id);
+	}
 }
 
-void os_initSchedulingInformation() {
-	// initialise level queues
-	for (uint8_t i = 0; i < 4; ++i) {
-		pqueue_init(&schedulingInfo.qs[i]);
-	}
-	// set initial mlfqSlices
-	for (uint8_t i = 1; i < 8; i++) {
-		if (os_getProcessSlot(i)->state != OS_PS_UNUSED) {
-			uint8_t q = os_getProcessSlot(i)->priority >> 6;
-			ProcessQueue *pq = &schedulingInfo.qs[3 - q];
-			pqueue_append(pq, i);
-			schedulingInfo.mlfq_slice[i] = 1 << (3 - q);
+/*!
+ *  Called when the effective priority of a process changed through priority
+ *  inheritance. The other strategies read the priority at every decision, the
+ *  MLFQ only at the start of a process, so a raised process is lifted to the
+ *  level of its new priority. A lowered one keeps its level until it uses up
+ *  its time slice.
+ *
+ *  \param id The process whose priority changed.
+ */
+void os_priorityChanged(ProcessID id) {
+	uint8_t const level = mlfq_levelOf(os_getProcessSlot(id)->priority);
+	if (id == 0 || level >= schedulingInfo.mlfq_level[id]) {
+		return;
+	}
+	bool const queued = schedulingInfo.mlfq_queued & PROCESS_BIT(id);
+	if (queued) {
+		mlfq_unlink(id);
+	}
+	schedulingInfo.mlfq_level[id] = level;
+	schedulingInfo.mlfq_slice[id] = 1 << level;
+	if (queued) {
+		mlfq_append(id, level);
+	}
+}
+
+void os_initSchedulingInformation(void) {
+	// empty all levels
+	for (uint8_t i = 0; i < MLFQ_LEVELS; ++i) {
+		schedulingInfo.mlfq_head[i] = INVALID_PROCESS;
+		schedulingInfo.mlfq_tail[i] = INVALID_PROCESS;
+	}
+	schedulingInfo.mlfq_nonEmpty = 0;
+	schedulingInfo.mlfq_queued = 0;
+	schedulingInfo.mlfq_boostTicks = 0;
+	// every process starts over in the level of its priority
+	for (uint8_t i = 1; i < MAX_NUMBER_OF_PROCESSES; i++) {
+		Process const* process = os_getProcessSlot(i);
+		if (process->state != OS_PS_UNUSED) {
+			uint8_t const level = mlfq_levelOf(process->priority);
+			schedulingInfo.mlfq_level[i] = level;
+			schedulingInfo.mlfq_slice[i] = 1 << level;
+			if (os_getReadyMask() & PROCESS_BIT(i)) {
+				mlfq_append(i, level);
+			}
 		}
 	}
 }
@@ -90,32 +165,18 @@ void os_resetSchedulingInformation(SchedulingStrategy strategy) {
 		case OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE:
 			os_initSchedulingInformation();
 			break;
-	}
-}
-
-void os_removeFromMlfq(ProcessID id) {
-
-	ProcessQueue localQueue;
-	pqueue_init(&localQueue);
-	ProcessQueue *processQueue;
-
-	for (int i = 0; i < 4; ++i) {
-		processQueue = &schedulingInfo.qs[i];
-		while (pqueue_hasNext(processQueue)) {
-			uint8_t temp = pqueue_getFirst(processQueue);
-			pqueue_dropFirst(processQueue);
-			if (temp != id) {
-				pqueue_append(&localQueue, temp);
+		case OS_SS_EDF:
+			break;
+		case OS_SS_STRIDE:
+			for (uint8_t i = 0; i < MAX_NUMBER_OF_PROCESSES; i++) {
+				schedulingInfo.pass[i] = 0;
 			}
-		}
-		while (pqueue_hasNext(&localQueue)) {
-			uint8_t temp = pqueue_getFirst(&localQueue);
-			pqueue_dropFirst(&localQueue);
-			pqueue_append(processQueue, temp);
-		}
+			schedulingInfo.globalPass = 0;
+			break;
 	}
 }
 
+
 /*!
  *  Reset the scheduling information for a specific process slot
  *  This is necessary when a new process is started to clear out any
@@ -133,12 +194,17 @@ void os_resetProcessSchedulingInformation(ProcessID id) {
 	}
 	
 
+	// a new process joins the stride strategy at the current virtual time
+	schedulingInfo.pass[id] = schedulingInfo.globalPass;
+
+	// the process starts over at the end of the level of its priority
 	os_removeFromMlfq(id);
-	// after execution of process add it to the back of its corresponding class 
-	uint8_t q = os_getProcessSlot(id)->priority >> 6;
-	ProcessQueue *pq = &schedulingInfo.qs[3 - q];
-	pqueue_append(pq, id);
-	schedulingInfo.mlfq_slice[id] = 1 << (3 - q);
+	uint8_t const level = mlfq_levelOf(os_getProcessSlot(id)->priority);
+	schedulingInfo.mlfq_level[id] = level;
+	schedulingInfo.mlfq_slice[id] = 1 << level;
+	if (id != 0 && (os_getReadyMask() & PROCESS_BIT(id))) {
+		mlfq_append(id, level);
+	}
 }
 
 /*!
@@ -152,19 +218,12 @@ void os_resetProcessSchedulingInformation(ProcessID id) {
  *  \return The next process to be executed determined on the basis of the even strategy.
  */
 ProcessID os_Scheduler_Even(Process const processes[], ProcessID current) {
-	uint8_t nextProc = (current + 1) % MAX_NUMBER_OF_PROCESSES;
-	while (nextProc != current) {
-		if (processes[nextProc].state == OS_PS_READY && nextProc != 0) {
-			return nextProc;
-		}
-		nextProc = (nextProc + 1) % MAX_NUMBER_OF_PROCESSES;
-	}
-	//here represents all other Processes(not include processes[0],as this represents the Leerlaufprozess) in the processes are not ready
-	if (processes[nextProc].state == OS_PS_READY) {
-		return nextProc;
-	} else {//all Processes are not ready, now run the Leerlaufprozess
+	// all ready processes except the Leerlaufprozess, which only runs if nobody else is ready
+	ProcessMask const candidates = os_getReadyMask() & ~PROCESS_BIT(0);
+	if (!candidates) {
 		return 0;
 	}
+	return os_nextProcessInMask(candidates, current);
 }
 
 /*!
@@ -176,26 +235,21 @@ ProcessID os_Scheduler_Even(Process const processes[], ProcessID current) {
  *  \return The next process to be executed determined on the basis of the random strategy.
  */
 ProcessID os_Scheduler_Random(Process const processes[], ProcessID current) {
-	//count the currently ready process excluding the idle process
-	uint8_t activPocess[MAX_NUMBER_OF_PROCESSES];
-	uint8_t numAktivProcess = 0;
-	//iterate the process array until we get the next process
-	for (uint8_t i = 0; i < MAX_NUMBER_OF_PROCESSES; i++) {
-		//since were using a random number between 0 and count we can just check if the process[i] is ready and not idle process and if its true check if the new count is 0.  
-		if (processes[i].state == OS_PS_READY && processes[i].progID != 0) {
-			//if it is 0 then return the id
-			//else decrement the count
-			activPocess[numAktivProcess] = i;
-			numAktivProcess++;
-		}
-	}
+	//the currently ready processes excluding the idle process
+	ProcessMask candidates = os_getReadyMask() & ~PROCESS_BIT(0);
+	uint8_t const numAktivProcess = os_countProcessesInMask(candidates);
 	
+	//if there is no process ready then return the idle process id
 	if (numAktivProcess == 0) {
 		return 0;
 	}
-	//if there is no process ready then return the idle process id
-
-	return activPocess[rand() % numAktivProcess];//get a random number 
+	
+	//drop the lowest members until the randomly chosen one is the lowest
+	uint8_t skip = rand() % numAktivProcess;
+	while (skip--) {
+		candidates &= candidates - 1;
+	}
+	return os_firstProcessInMask(candidates);
 }
 
 /*!
@@ -236,41 +290,39 @@ ProcessID os_Scheduler_RoundRobin(Process const processes[], ProcessID current)
  */
 ProcessID os_Scheduler_InactiveAging(Process const processes[], ProcessID current) {
     // This is a presence task
-	for (uint8_t i = 1; i < MAX_NUMBER_OF_PROCESSES; i++) {
-		if (i != current && processes[i].state == OS_PS_READY) {
-			schedulingInfo.age[i] += processes[i].priority;
-		}
+	//processes[0] is Leerlaufprozess, it is only chosen if no other process is ready
+	ProcessMask const candidates = os_getReadyMask() & ~PROCESS_BIT(0);
+	if (!candidates) {
+		return 0;
 	}
 	
+	//only the waiting processes age, so we walk the set bits instead of the whole array
+	ProcessMask waiting = candidates & ~PROCESS_BIT(current);
+	while (waiting) {
+		ProcessID const i = os_firstProcessInMask(waiting);
+		schedulingInfo.age[i] += processes[i].priority;
+		waiting &= waiting - 1;
+	}
 	
-	//processes[0] is Leerlaufprozess, availabe prozess is processes[1] to processes[MAX_NUMBER_OF_PROCESSES-1]?
-	uint8_t oldestProc = 1;
-	for (uint8_t i = 2; i < MAX_NUMBER_OF_PROCESSES; i++) {
-		
-		if (processes[i].state != OS_PS_READY) {
-			continue;
-		}
+	//members are visited in increasing order, so on a complete tie the lower ProcessID wins
+	ProcessMask remaining = candidates;
+	ProcessID oldestProc = os_firstProcessInMask(remaining);
+	remaining &= remaining - 1;
+	while (remaining) {
+		ProcessID const i = os_firstProcessInMask(remaining);
+		remaining &= remaining - 1;
 		
 		if (schedulingInfo.age[i] > schedulingInfo.age[oldestProc]) {
 			oldestProc = i;
+		} else if (schedulingInfo.age[i] == schedulingInfo.age[oldestProc]
+		           && processes[i].priority > processes[oldestProc].priority) {
+			oldestProc = i;
 		}
-		
-		if (schedulingInfo.age[i] == schedulingInfo.age[oldestProc]) {
-			if (processes[i].priority == processes[oldestProc].priority) {
-				oldestProc = i < oldestProc ? i : oldestProc;
-			} else {
-				oldestProc = processes[i].priority > processes[oldestProc].priority ? i : oldestProc;
-			}
-		}
-	}
-	
-	if (processes[oldestProc].state != OS_PS_READY) {
-		return 0;
 	}
 	
 	schedulingInfo.age[oldestProc] = processes[oldestProc].priority;	
 	
-	return oldestProc;//if pid=0 here means that no other process isRunnable
+	return oldestProc;
 }
 
 /*!
@@ -291,42 +343,153 @@ ProcessID os_Scheduler_RunToCompletion(Process const processes[], ProcessID curr
 	}
 }
 
-//MultiLevelFeedbackQueue strategy.
-ProcessID os_Scheduler_MLFQ(Process const processes[], ProcessID current) {
+/*!
+ *  Moves every process back to the highest level, so processes that were
+ *  demoted to the lowest level by CPU hogs or a stream of short jobs get the
+ *  CPU again. The order of the ready processes is kept.
+ */
+static void mlfq_boost(void) {
+	for (uint8_t level = 1; level < MLFQ_LEVELS; level++) {
+		ProcessID pid;
+		while ((pid = schedulingInfo.mlfq_head[level]) != INVALID_PROCESS) {
+			mlfq_unlink(pid);
+			mlfq_append(pid, 0);
+		}
+	}
+	// processes that are not ready right now start over at the top as well
+	for (ProcessID pid = 1; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+		schedulingInfo.mlfq_level[pid] = 0;
+		schedulingInfo.mlfq_slice[pid] = 1;
+	}
+}
 
-	for (uint8_t i = 0; i < 4; ++i) {
-		ProcessQueue *q = &schedulingInfo.qs[i];
-		if (pqueue_hasNext(q)) {
-			ProcessID next = pqueue_getFirst(q);
-
-			if (processes[next].state == OS_PS_UNUSED) {
-				pqueue_dropFirst(q);
-				if (pqueue_hasNext(q)) {
-					next = pqueue_getFirst(q);
-				} else {
-					continue;
-				}
-			}
+/*!
+ *  Sets the number of scheduling decisions after which the MLFQ moves every
+ *  process back to the highest level.
+ *
+ *  \param interval Number of scheduling decisions, 0 disables the boost.
+ */
+void os_setMlfqBoostInterval(uint16_t interval) {
+	os_enterCriticalSection();
+	mlfqBoostInterval = interval;
+	schedulingInfo.mlfq_boostTicks = 0;
+	os_leaveCriticalSection();
+}
 
-			if (processes[next].state == OS_PS_BLOCKED) {
-				pqueue_dropFirst(q);
-				pqueue_append(q, next);
-				ProcessID nextnext = pqueue_getFirst(q);
-				if (nextnext == next) {
-					continue;
-				} else {
-					next = nextnext;
-				}
-			}
+//! Returns the number of scheduling decisions between two MLFQ boosts (0 if disabled).
+uint16_t os_getMlfqBoostInterval(void) {
+	return mlfqBoostInterval;
+}
 
-			if (--schedulingInfo.mlfq_slice[next] == 0) {
-				pqueue_dropFirst(q);
-				uint8_t a = i != 3 ? 1 : 0;
-				pqueue_append(q + a, next);
-				schedulingInfo.mlfq_slice[next] = 1 << (i + a);
+/*!
+ *  MultiLevelFeedbackQueue strategy. The process that ran is only charged if
+ *  it was preempted, i.e. it is still ready. A process that blocked, yielded
+ *  or went to sleep before its slice was used up keeps its level and the rest
+ *  of its slice.
+ *
+ *  \param processes An array holding the processes to choose the next process from.
+ *  \param current The id of the current process.
+ *  \return The first process of the highest non-empty level.
+ */
+ProcessID os_Scheduler_MLFQ(Process const processes[], ProcessID current) {
+	if (schedulingInfo.mlfq_queued & PROCESS_BIT(current)) {
+		if (--schedulingInfo.mlfq_slice[current] == 0) {
+			uint8_t level = schedulingInfo.mlfq_level[current];
+			mlfq_unlink(current);
+			if (level != MLFQ_LEVELS - 1) {
+				level++;
 			}
-			return next;
+			mlfq_append(current, level);
+			schedulingInfo.mlfq_slice[current] = 1 << level;
+		}
+	}
+
+	if (mlfqBoostInterval && ++schedulingInfo.mlfq_boostTicks >= mlfqBoostInterval) {
+		schedulingInfo.mlfq_boostTicks = 0;
+		mlfq_boost();
+	}
+
+	uint8_t const nonEmpty = schedulingInfo.mlfq_nonEmpty;
+	if (!nonEmpty) {
+		return 0;
+	}
+
+	// the highest level that holds a ready process
+	uint8_t level = 0;
+	while (!(nonEmpty & (1 << level))) {
+		level++;
+	}
+	return schedulingInfo.mlfq_head[level];
+}
+
+/*!
+ *  This function implements the earliest deadline first strategy. Of all ready
+ *  processes, the one whose current job has the earliest absolute deadline is
+ *  chosen. Processes that are not periodic have no deadline and only get the
+ *  CPU while no periodic job is pending. Processes with the same deadline take
+ *  turns, as the search starts after the current process.
+ *
+ *  \param processes An array holding the processes to choose the next process from.
+ *  \param current The id of the current process.
+ *  \return The next process to be executed determined on the basis of the EDF strategy.
+ */
+ProcessID os_Scheduler_EDF(Process const processes[], ProcessID current) {
+	ProcessMask const candidates = os_getReadyMask() & ~PROCESS_BIT(0);
+	if (!candidates) {
+		return 0;
+	}
+
+	ProcessID pid = os_nextProcessInMask(candidates, current);
+	ProcessID best = pid;
+	Time bestDeadline = os_getDeadline(pid);
+	for (uint8_t n = os_countProcessesInMask(candidates); n > 1; n--) {
+		pid = os_nextProcessInMask(candidates, pid);
+		Time const deadline = os_getDeadline(pid);
+		if (deadline < bestDeadline) {
+			best = pid;
+			bestDeadline = deadline;
 		}
 	}
-	return 0;
-}
\ No newline at end of file
+	return best;
+}
+
+/*!
+ *  This function implements the stride strategy. The priority of a process is
+ *  its number of tickets (at least one). Every process has a pass value that
+ *  advances by STRIDE_ONE / tickets each time it is chosen, and the ready
+ *  process with the smallest pass runs next. So the CPU shares converge to
+ *  the ratio of the tickets without any random numbers.
+ *  A process that was not ready for a while (sleeping, waiting, new) does not
+ *  save up credit: its pass is raised to the pass of the last chosen process.
+ *
+ *  \param processes An array holding the processes to choose the next process from.
+ *  \param current The id of the current process.
+ *  \return The next process to be executed determined on the basis of the stride strategy.
+ */
+ProcessID os_Scheduler_Stride(Process const processes[], ProcessID current) {
+	ProcessMask candidates = os_getReadyMask() & ~PROCESS_BIT(0);
+	if (!candidates) {
+		return 0;
+	}
+
+	uint16_t const globalPass = schedulingInfo.globalPass;
+	ProcessID best = INVALID_PROCESS;
+	uint16_t bestPass = 0;
+	while (candidates) {
+		ProcessID const pid = os_firstProcessInMask(candidates);
+		candidates &= candidates - 1;
+		// passes wrap around, compare their distance instead
+		if ((int16_t)(schedulingInfo.pass[pid] - globalPass) < 0) {
+			schedulingInfo.pass[pid] = globalPass;
+		}
+		if (best == INVALID_PROCESS || (int16_t)(schedulingInfo.pass[pid] - bestPass) < 0) {
+			best = pid;
+			bestPass = schedulingInfo.pass[pid];
+		}
+	}
+
+	Priority const tickets = processes[best].priority ? processes[best].priority : 1;
+	schedulingInfo.globalPass = bestPass;
+	schedulingInfo.pass[best] = bestPass + STRIDE_ONE / tickets;
+	return best;
+}
@@ -14,35 +14,29 @@
 #include "os_scheduler.h"
 #include "defines.h"
 
-typedef struct ProcessQueue {
-	ProcessID data[MAX_NUMBER_OF_PROCESSES];
-	uint8_t size;
-	uint8_t head;
-	uint8_t tail;
-} ProcessQueue;
+//! Number of levels of the multi level feedback queue (0 is the highest)
+#define MLFQ_LEVELS 4
 
 //! Structure used to store specific scheduling informations such as a time slice
 // This is a presence task
 typedef struct{
 	uint8_t timeSlice;
 	Age age[MAX_NUMBER_OF_PROCESSES];
-	uint8_t mlfq_slice[8];
-	ProcessQueue qs[4];
+	// MLFQ: one doubly linked list per level, linked through the ProcessIDs
+	uint8_t mlfq_slice[MAX_NUMBER_OF_PROCESSES];
+	uint8_t mlfq_level[MAX_NUMBER_OF_PROCESSES];
+	ProcessID mlfq_next[MAX_NUMBER_OF_PROCESSES];
+	ProcessID mlfq_prev[MAX_NUMBER_OF_PROCESSES];
+	ProcessID mlfq_head[MLFQ_LEVELS];
+	ProcessID mlfq_tail[MLFQ_LEVELS];
+	uint8_t mlfq_nonEmpty;      //!< Bit i is set if level i holds a process
+	ProcessMask mlfq_queued;    //!< Processes that are in one of the lists
+	uint16_t mlfq_boostTicks;   //!< Scheduling decisions since the last boost
+	uint16_t pass[MAX_NUMBER_OF_PROCESSES];
+	uint16_t globalPass;
 } SchedulingInformation;
 
 
-void pqueue_init(ProcessQueue* queue);
-
-void pqueue_reset(ProcessQueue* queue);
-
-uint8_t pqueue_hasNext(ProcessQueue* queue);
-
-ProcessID pqueue_getFirst(ProcessQueue* queue);
-
-void pqueue_dropFirst(ProcessQueue* queue);
-
-void pqueue_append(ProcessQueue* queue, ProcessID pid);
-
 //! Used to reset the SchedulingInfo for one process
 void os_resetProcessSchedulingInformation(ProcessID id);
 
@@ -64,10 +58,37 @@ ProcessID os_Scheduler_InactiveAging(Process const processes[], ProcessID curren
 //! RunToCompletion strategy
 ProcessID os_Scheduler_RunToCompletion(Process const processes[], ProcessID current);
 
-ProcessQueue* MLFQ_getQueue(uint8_t queueID);
+//! Rebuilds the MLFQ levels from the current processes
+void os_initSchedulingInformation(void);
+
+//! Returns the first process in an MLFQ level (INVALID_PROCESS if empty)
+ProcessID MLFQ_getFirst(uint8_t level);
 
+//! Returns the successor of a process in its MLFQ level (INVALID_PROCESS at the end)
+ProcessID MLFQ_getNext(ProcessID pid);
+
+//! Appends a process that became ready to its MLFQ level
+void os_mlfqEnqueue(ProcessID id);
+
+//! Takes a process that is no longer ready out of its MLFQ level
 void os_removeFromMlfq(ProcessID id);
 
+//! Adapts the scheduling information to a changed effective priority
+void os_priorityChanged(ProcessID id);
+
+//! Sets the number of scheduling decisions between two MLFQ boosts (0 disables it)
+void os_setMlfqBoostInterval(uint16_t interval);
+
+//! Returns the number of scheduling decisions between two MLFQ boosts
+uint16_t os_getMlfqBoostInterval(void);
+
+//! MultiLevelFeedbackQueue strategy
 ProcessID os_Scheduler_MLFQ(Process const processes[], ProcessID current);
 
+//! Earliest deadline first strategy
+ProcessID os_Scheduler_EDF(Process const processes[], ProcessID current);
+
+//! Stride strategy
+ProcessID os_Scheduler_Stride(Process const processes[], ProcessID current);
+
 #endif
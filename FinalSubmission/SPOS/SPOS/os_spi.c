@@ -23,41 +23,34 @@ void os_spi_slave_deselect(){
 	PORTB |= 0b00010000;
 }
 
+// Einzelne Bytes nur innerhalb einer Transaktion senden/empfangen, die den
+// Bus schon gegen Preemption schtzt. Kein Interrupt-Handler benutzt den Bus.
 uint8_t os_spi_send(uint8_t data) {
-	os_enterCriticalSection();
-
 	//send data
 	SPDR = data;
 	waitForSerialFinish();
 
-	os_leaveCriticalSection();
 	return SPDR;
 }
 
 uint8_t os_spi_receive() {
-	
-	os_enterCriticalSection();
-
 	//DummyBits senden
 	SPDR = 0xFF;
 	waitForSerialFinish();
-	uint8_t res = SPDR;
-	
-	os_leaveCriticalSection();
-	return res;
+	return SPDR;
 }
 
 void os_spi_wrmr(uint8_t data) {
-	os_enterCriticalSection();
+	os_preemptDisable();
 	os_spi_slave_select();
 	os_spi_send(CMD_WRMR);
 	os_spi_send(data);
 	os_spi_slave_deselect();
-	os_leaveCriticalSection();
+	os_preemptEnable();
 }
 
 void os_spi_write(MemAddr addr, MemValue data) {
-	os_enterCriticalSection();
+	os_preemptDisable();
 	os_spi_slave_select();
 	os_spi_send(CMD_WRITE);
 	//adresse 24 bit, don't care 8 send as first see 23LC1024 p5, bit 23-16
@@ -68,11 +61,11 @@ void os_spi_write(MemAddr addr, MemValue data) {
 	os_spi_send(addr);
 	os_spi_send(data);
 	os_spi_slave_deselect();
-	os_leaveCriticalSection();
+	os_preemptEnable();
 }
 
 MemValue os_spi_read(MemAddr addr) {
-	os_enterCriticalSection();
+	os_preemptDisable();
 	os_spi_slave_select();
 	os_spi_send(CMD_READ);
 	//adresse 24 bit, don't care 8 send as first see 23LC1024 p5, bit 23-16
@@ -83,7 +76,7 @@ MemValue os_spi_read(MemAddr addr) {
 	os_spi_send(addr);
 	uint8_t res = os_spi_receive();
 	os_spi_slave_deselect();
-	os_leaveCriticalSection();
+	os_preemptEnable();
 	return res; 
 }
 
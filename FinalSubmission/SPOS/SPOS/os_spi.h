@@ -13,10 +13,10 @@
 //Configures relevant I/O registers/pins and initializes the SPI module.
 void os_spi_init(void);
 
-//send informationen zu Slave 
+//send informationen zu Slave (nur innerhalb einer Transaktion, ungeschtzt)
 uint8_t os_spi_send(uint8_t data);
 
-//empfang info from slave
+//empfang info from slave (nur innerhalb einer Transaktion, ungeschtzt)
 uint8_t os_spi_receive();
 
 MemValue os_spi_read(MemAddr addr);
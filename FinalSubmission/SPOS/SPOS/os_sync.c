@@ -0,0 +1,504 @@
+#include "os_sync.h"
+#include "os_scheduler.h"
+#include "os_scheduling_strategies.h"
+#include "os_core.h"
+#include "defines.h"
+
+//----------------------------------------------------------------------------
+// Private variables
+//----------------------------------------------------------------------------
+
+//! Successor of each waiting process in the wait queue it belongs to.
+static ProcessID waitNext[MAX_NUMBER_OF_PROCESSES];
+
+//! Wait queue each waiting process belongs to (NULL if it does not wait).
+static WaitQueue* waitingOn[MAX_NUMBER_OF_PROCESSES];
+
+//! First mutex of the list of mutexes each process holds.
+static Mutex* ownedMutexes[MAX_NUMBER_OF_PROCESSES];
+
+//! Mutex each waiting process waits for (NULL if it waits for something else).
+static Mutex* waitingForMutex[MAX_NUMBER_OF_PROCESSES];
+
+//! A shared memory chunk, identified by its heap and its first byte
+typedef struct {
+	Heap const* heap;
+	MemAddr chunk;
+} ChunkRef;
+
+//! Shared chunks each process holds open (heap NULL: free entry).
+static ChunkRef heldChunks[MAX_NUMBER_OF_PROCESSES][SYNC_HELD_CHUNKS];
+
+//! Shared chunk each process waits for (heap NULL: none).
+static ChunkRef waitingForChunk[MAX_NUMBER_OF_PROCESSES];
+
+static void os_syncUpdateChunkHolders(Heap const* heap, MemAddr chunk, uint8_t depth);
+static void os_wakeChunkWaiters(Heap const* heap, MemAddr chunk);
+
+//----------------------------------------------------------------------------
+// Wait queues
+//----------------------------------------------------------------------------
+
+/*!
+ *  Appends the current process to the wait queue and gives up the CPU until
+ *  os_wakeFirst hands the object to it. Must be called inside a critical
+ *  section.
+ *
+ *  \param queue The wait queue of the object the process waits for.
+ */
+static void os_waitIn(WaitQueue* queue) {
+	ProcessID pid = os_getCurrentProc();
+	waitNext[pid] = INVALID_PROCESS;
+	waitingOn[pid] = queue;
+	if (queue->head == INVALID_PROCESS) {
+		queue->head = pid;
+	} else {
+		waitNext[queue->tail] = pid;
+	}
+	queue->tail = pid;
+	os_suspendCurrent(OS_PS_WAITING);
+}
+
+/*!
+ *  Removes the first process from the wait queue and makes it READY.
+ *  Must be called inside a critical section.
+ *
+ *  \param queue The wait queue of the object that is released.
+ *  \return The woken process or INVALID_PROCESS if nobody waits.
+ */
+static ProcessID os_wakeFirst(WaitQueue* queue) {
+	ProcessID pid = queue->head;
+	if (pid == INVALID_PROCESS) {
+		return INVALID_PROCESS;
+	}
+	queue->head = waitNext[pid];
+	if (queue->head == INVALID_PROCESS) {
+		queue->tail = INVALID_PROCESS;
+	}
+	waitingOn[pid] = NULL;
+	os_setProcessState(pid, OS_PS_READY);
+	return pid;
+}
+
+/*!
+ *  Takes a process out of the wait queue it is in, e.g. because it is killed.
+ *  Must be called inside a critical section.
+ *
+ *  \param pid The process to remove.
+ */
+static void os_leaveWaitQueue(ProcessID pid) {
+	WaitQueue* queue = waitingOn[pid];
+	if (queue == NULL) {
+		return;
+	}
+	ProcessID prev = INVALID_PROCESS;
+	for (ProcessID i = queue->head; i != INVALID_PROCESS; prev = i, i = waitNext[i]) {
+		if (i != pid) {
+			continue;
+		}
+		if (prev == INVALID_PROCESS) {
+			queue->head = waitNext[pid];
+		} else {
+			waitNext[prev] = waitNext[pid];
+		}
+		if (queue->tail == pid) {
+			queue->tail = prev;
+		}
+		break;
+	}
+	waitingOn[pid] = NULL;
+}
+
+//----------------------------------------------------------------------------
+// Semaphores
+//----------------------------------------------------------------------------
+
+/*!
+ *  Initializes a semaphore. Must not be called while processes wait for it.
+ *
+ *  \param sem The semaphore.
+ *  \param count The initial number of available units.
+ */
+void os_semInit(Semaphore* sem, uint8_t count) {
+	sem->count = count;
+	sem->waiters.head = INVALID_PROCESS;
+	sem->waiters.tail = INVALID_PROCESS;
+}
+
+/*!
+ *  Takes one unit of the semaphore. If none is available, the process waits
+ *  without using the CPU until os_semSignal passes a unit to it.
+ *
+ *  \param sem The semaphore.
+ */
+void os_semWait(Semaphore* sem) {
+	os_enterCriticalSection();
+	if (sem->count > 0) {
+		sem->count--;
+	} else {
+		// The unit is handed over directly, so count stays untouched
+		os_waitIn(&sem->waiters);
+	}
+	os_leaveCriticalSection();
+}
+
+/*!
+ *  Takes one unit of the semaphore if one is available.
+ *
+ *  \param sem The semaphore.
+ *  \return True if a unit was taken.
+ */
+bool os_semTryWait(Semaphore* sem) {
+	os_enterCriticalSection();
+	bool taken = sem->count > 0;
+	if (taken) {
+		sem->count--;
+	}
+	os_leaveCriticalSection();
+	return taken;
+}
+
+/*!
+ *  Returns one unit to the semaphore. If processes wait for it, the unit goes
+ *  to the one that waits longest, which becomes READY.
+ *
+ *  \param sem The semaphore.
+ */
+void os_semSignal(Semaphore* sem) {
+	os_enterCriticalSection();
+	if (os_wakeFirst(&sem->waiters) == INVALID_PROCESS) {
+		if (sem->count == UINT8_MAX) {
+			os_error("Semaphore       overflow");
+		}
+		sem->count++;
+	}
+	os_leaveCriticalSection();
+}
+
+//----------------------------------------------------------------------------
+// Mutexes
+//----------------------------------------------------------------------------
+
+/*!
+ *  Adds a mutex to the list of mutexes held by its new owner.
+ *
+ *  \param mutex The mutex.
+ *  \param pid The new owner.
+ */
+static void os_takeMutex(Mutex* mutex, ProcessID pid) {
+	mutex->owner = pid;
+	mutex->nextOwned = ownedMutexes[pid];
+	ownedMutexes[pid] = mutex;
+}
+
+/*!
+ *  Releases a mutex held by pid. The process that waits longest becomes the
+ *  new owner. Must be called inside a critical section.
+ *
+ *  \param mutex The mutex.
+ *  \param pid The current owner.
+ */
+static void os_releaseMutex(Mutex* mutex, ProcessID pid) {
+	if (ownedMutexes[pid] == mutex) {
+		ownedMutexes[pid] = mutex->nextOwned;
+	} else {
+		Mutex* prev = ownedMutexes[pid];
+		while (prev->nextOwned != mutex) {
+			prev = prev->nextOwned;
+		}
+		prev->nextOwned = mutex->nextOwned;
+	}
+	mutex->nextOwned = NULL;
+
+	ProcessID next = os_wakeFirst(&mutex->waiters);
+	if (next == INVALID_PROCESS) {
+		mutex->owner = INVALID_PROCESS;
+	} else {
+		waitingForMutex[next] = NULL;
+		os_takeMutex(mutex, next);
+		// the remaining waiters boost the new owner
+		os_syncUpdatePriority(next);
+	}
+	// the old owner drops what it inherited through this mutex
+	os_syncUpdatePriority(pid);
+}
+
+/*!
+ *  Initializes a mutex as free. Must not be called while it is held.
+ *
+ *  \param mutex The mutex.
+ */
+void os_mutexInit(Mutex* mutex) {
+	mutex->owner = INVALID_PROCESS;
+	mutex->waiters.head = INVALID_PROCESS;
+	mutex->waiters.tail = INVALID_PROCESS;
+	mutex->nextOwned = NULL;
+}
+
+/*!
+ *  Acquires the mutex. If another process holds it, the current process waits
+ *  without using the CPU until the mutex is handed to it. Mutexes are not
+ *  recursive, locking a held mutex again is an error.
+ *
+ *  \param mutex The mutex.
+ */
+void os_mutexLock(Mutex* mutex) {
+	os_enterCriticalSection();
+	ProcessID pid = os_getCurrentProc();
+	if (mutex->owner == INVALID_PROCESS) {
+		os_takeMutex(mutex, pid);
+	} else if (mutex->owner == pid) {
+		os_error("Mutex locked    twice");
+	} else {
+		// os_releaseMutex makes us the owner before waking us up
+		waitingForMutex[pid] = mutex;
+		os_syncUpdatePriority(mutex->owner);
+		os_waitIn(&mutex->waiters);
+	}
+	os_leaveCriticalSection();
+}
+
+/*!
+ *  Acquires the mutex if it is free.
+ *
+ *  \param mutex The mutex.
+ *  \return True if the current process holds the mutex now.
+ */
+bool os_mutexTryLock(Mutex* mutex) {
+	os_enterCriticalSection();
+	bool taken = mutex->owner == INVALID_PROCESS;
+	if (taken) {
+		os_takeMutex(mutex, os_getCurrentProc());
+	}
+	os_leaveCriticalSection();
+	return taken;
+}
+
+/*!
+ *  Releases the mutex. Only the process that holds it may do so.
+ *
+ *  \param mutex The mutex.
+ */
+void os_mutexUnlock(Mutex* mutex) {
+	os_enterCriticalSection();
+	if (mutex->owner != os_getCurrentProc()) {
+		os_error("Mutex unlocked  by non-owner");
+	} else {
+		os_releaseMutex(mutex, mutex->owner);
+	}
+	os_leaveCriticalSection();
+}
+
+//----------------------------------------------------------------------------
+// Process termination
+//----------------------------------------------------------------------------
+
+/*!
+ *  Called by os_kill before the slot of a process is freed. The process leaves
+ *  the wait queue it is in and all mutexes it holds are passed on, so no other
+ *  process waits forever for a dead one.
+ *
+ *  \param pid The process that is killed.
+ */
+void os_syncCleanup(ProcessID pid) {
+	os_enterCriticalSection();
+	os_leaveWaitQueue(pid);
+	// whoever the process waited for loses its priority
+	Mutex* mutex = waitingForMutex[pid];
+	waitingForMutex[pid] = NULL;
+	if (mutex != NULL) {
+		os_syncUpdatePriority(mutex->owner);
+	}
+	ChunkRef const chunk = waitingForChunk[pid];
+	waitingForChunk[pid].heap = NULL;
+	if (chunk.heap != NULL) {
+		os_syncUpdateChunkHolders(chunk.heap, chunk.chunk, 0);
+	}
+	// waiters for the chunks it held open check them again
+	for (uint8_t i = 0; i < SYNC_HELD_CHUNKS; i++) {
+		ChunkRef const held = heldChunks[pid][i];
+		heldChunks[pid][i].heap = NULL;
+		if (held.heap != NULL) {
+			os_wakeChunkWaiters(held.heap, held.chunk);
+		}
+	}
+	while (ownedMutexes[pid] != NULL) {
+		os_releaseMutex(ownedMutexes[pid], pid);
+	}
+	os_leaveCriticalSection();
+}
+
+//----------------------------------------------------------------------------
+// Priority inheritance
+//----------------------------------------------------------------------------
+
+//! Whether pid holds the passed chunk open
+static bool os_holdsChunk(ProcessID pid, Heap const* heap, MemAddr chunk) {
+	for (uint8_t i = 0; i < SYNC_HELD_CHUNKS; i++) {
+		if (heldChunks[pid][i].heap == heap && heldChunks[pid][i].chunk == chunk) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*!
+ *  Recalculates the effective priority of a process: its base priority or the
+ *  highest effective priority of the processes that wait for a mutex it owns or
+ *  a chunk it holds open. If the priority changed and the process waits itself,
+ *  the change is passed on to whom it waits for. Must be called inside a
+ *  critical section.
+ *
+ *  \param pid The process.
+ *  \param depth Number of processes the change was passed through (ends cycles).
+ */
+static void os_syncUpdatePriorityDepth(ProcessID pid, uint8_t depth) {
+	if (pid >= MAX_NUMBER_OF_PROCESSES || depth >= MAX_NUMBER_OF_PROCESSES) {
+		return;
+	}
+	Process* process = os_getProcessSlot(pid);
+	Priority priority = process->basePriority;
+	for (Mutex* mutex = ownedMutexes[pid]; mutex != NULL; mutex = mutex->nextOwned) {
+		for (ProcessID w = mutex->waiters.head; w != INVALID_PROCESS; w = waitNext[w]) {
+			if (os_getProcessSlot(w)->priority > priority) {
+				priority = os_getProcessSlot(w)->priority;
+			}
+		}
+	}
+	for (ProcessID w = 0; w < MAX_NUMBER_OF_PROCESSES; w++) {
+		ChunkRef const* chunk = &waitingForChunk[w];
+		if (chunk->heap != NULL && os_getProcessSlot(w)->priority > priority && os_holdsChunk(pid, chunk->heap, chunk->chunk)) {
+			priority = os_getProcessSlot(w)->priority;
+		}
+	}
+	if (priority == process->priority) {
+		return;
+	}
+	process->priority = priority;
+	os_priorityChanged(pid);
+
+	// pass it on along the chain of waiting processes
+	if (waitingForMutex[pid] != NULL) {
+		os_syncUpdatePriorityDepth(waitingForMutex[pid]->owner, depth + 1);
+	}
+	if (waitingForChunk[pid].heap != NULL) {
+		os_syncUpdateChunkHolders(waitingForChunk[pid].heap, waitingForChunk[pid].chunk, depth + 1);
+	}
+}
+
+//! Recalculates the priority of every process that holds the passed chunk open
+static void os_syncUpdateChunkHolders(Heap const* heap, MemAddr chunk, uint8_t depth) {
+	for (ProcessID pid = 1; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+		if (os_holdsChunk(pid, heap, chunk)) {
+			os_syncUpdatePriorityDepth(pid, depth);
+		}
+	}
+}
+
+/*!
+ *  Recalculates the effective priority of a process, e.g. after it released
+ *  something others waited for.
+ *
+ *  \param pid The process.
+ */
+void os_syncUpdatePriority(ProcessID pid) {
+	os_enterCriticalSection();
+	os_syncUpdatePriorityDepth(pid, 0);
+	os_leaveCriticalSection();
+}
+
+/*!
+ *  Changes the priority a process was given. While it inherits a higher one
+ *  from a waiter, the inherited priority stays in effect until the release.
+ *
+ *  \param pid The process.
+ *  \param priority The new base priority.
+ */
+void os_setBasePriority(ProcessID pid, Priority priority) {
+	os_enterCriticalSection();
+	os_getProcessSlot(pid)->basePriority = priority;
+	os_syncUpdatePriorityDepth(pid, 0);
+	os_leaveCriticalSection();
+}
+
+/*!
+ *  Called by os_sh_readOpen and os_sh_writeOpen while the current process
+ *  cannot open a chunk. Every process that holds the chunk open runs with at
+ *  least the priority of the current process until it closes it. The current
+ *  process waits without using the CPU until somebody closes the chunk, then
+ *  the caller checks again whether it may open it.
+ *
+ *  \param heap The heap of the chunk.
+ *  \param chunk The first byte of the chunk.
+ */
+void os_syncChunkWait(Heap const* heap, MemAddr chunk) {
+	os_enterCriticalSection();
+	ProcessID const pid = os_getCurrentProc();
+	waitingForChunk[pid].heap = heap;
+	waitingForChunk[pid].chunk = chunk;
+	os_syncUpdateChunkHolders(heap, chunk, 0);
+	os_suspendCurrent(OS_PS_WAITING);
+	os_leaveCriticalSection();
+}
+
+/*!
+ *  Makes every process that waits for the passed chunk READY again. They stay
+ *  registered as waiters, so the holders keep their priority until a waiter
+ *  opened the chunk or waits again. Must be called inside a critical section.
+ *
+ *  \param heap The heap of the chunk.
+ *  \param chunk The first byte of the chunk.
+ */
+static void os_wakeChunkWaiters(Heap const* heap, MemAddr chunk) {
+	for (ProcessID w = 1; w < MAX_NUMBER_OF_PROCESSES; w++) {
+		if (waitingForChunk[w].heap == heap && waitingForChunk[w].chunk == chunk && os_getProcessSlot(w)->state == OS_PS_WAITING) {
+			os_setProcessState(w, OS_PS_READY);
+		}
+	}
+}
+
+/*!
+ *  Called by os_sh_readOpen and os_sh_writeOpen once the current process
+ *  opened the chunk. If it holds more than SYNC_HELD_CHUNKS chunks at a time,
+ *  the others are not considered for priority inheritance.
+ *
+ *  \param heap The heap of the chunk.
+ *  \param chunk The first byte of the chunk.
+ */
+void os_syncChunkOpened(Heap const* heap, MemAddr chunk) {
+	os_enterCriticalSection();
+	ProcessID const pid = os_getCurrentProc();
+	waitingForChunk[pid].heap = NULL;
+	for (uint8_t i = 0; i < SYNC_HELD_CHUNKS; i++) {
+		if (heldChunks[pid][i].heap == NULL) {
+			heldChunks[pid][i].heap = heap;
+			heldChunks[pid][i].chunk = chunk;
+			break;
+		}
+	}
+	// others may already wait for it
+	os_syncUpdatePriorityDepth(pid, 0);
+	os_leaveCriticalSection();
+}
+
+/*!
+ *  Called by os_sh_close. The current process drops the priority it inherited
+ *  from the processes that wait for the chunk, and the waiters check again
+ *  whether they can open it.
+ *
+ *  \param heap The heap of the chunk.
+ *  \param chunk The first byte of the chunk.
+ */
+void os_syncChunkClosed(Heap const* heap, MemAddr chunk) {
+	os_enterCriticalSection();
+	ProcessID const pid = os_getCurrentProc();
+	for (uint8_t i = 0; i < SYNC_HELD_CHUNKS; i++) {
+		if (heldChunks[pid][i].heap == heap && heldChunks[pid][i].chunk == chunk) {
+			heldChunks[pid][i].heap = NULL;
+			break;
+		}
+	}
+	os_syncUpdatePriorityDepth(pid, 0);
+	os_wakeChunkWaiters(heap, chunk);
+	os_leaveCriticalSection();
+}
@@ -0,0 +1,98 @@
+/*! \file
+ *  \brief Blocking synchronization primitives.
+ *
+ *  Counting semaphores and mutexes. A process that has to wait is put into the
+ *  state OS_PS_WAITING and appended to the wait queue of the object, so it is
+ *  not considered by the scheduler until it is woken up by the release.
+ *
+ *  Mutexes and open shared memory chunks use priority inheritance: as long as
+ *  a process waits for one of them, every holder runs with at least the
+ *  priority of the waiter. The priority field of a process is this effective
+ *  priority, basePriority the one it was given.
+ */
+
+#ifndef _OS_SYNC_H
+#define _OS_SYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "os_process.h"
+#include "os_memheap_drivers.h"
+
+//----------------------------------------------------------------------------
+// Types
+//----------------------------------------------------------------------------
+
+//! FIFO of processes that wait for a synchronization object
+typedef struct WaitQueue {
+	ProcessID head;
+	ProcessID tail;
+} WaitQueue;
+
+//! A counting semaphore
+typedef struct Semaphore {
+	uint8_t count;
+	WaitQueue waiters;
+} Semaphore;
+
+//! A mutex that can only be released by the process that holds it
+typedef struct Mutex {
+	ProcessID owner;
+	WaitQueue waiters;
+	struct Mutex* nextOwned;    //!< Next mutex held by the same owner
+} Mutex;
+
+//! Static initializer for a semaphore with the passed count
+#define SEMAPHORE_INIT(COUNT) { .count = (COUNT), .waiters = { INVALID_PROCESS, INVALID_PROCESS } }
+
+//! Static initializer for a free mutex
+#define MUTEX_INIT { .owner = INVALID_PROCESS, .waiters = { INVALID_PROCESS, INVALID_PROCESS }, .nextOwned = NULL }
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! Initializes a semaphore with the passed count
+void os_semInit(Semaphore* sem, uint8_t count);
+
+//! Decrements the semaphore, waits while it is zero
+void os_semWait(Semaphore* sem);
+
+//! Decrements the semaphore if it is not zero, never waits
+bool os_semTryWait(Semaphore* sem);
+
+//! Increments the semaphore or hands it to the first waiting process
+void os_semSignal(Semaphore* sem);
+
+//! Initializes a mutex as free
+void os_mutexInit(Mutex* mutex);
+
+//! Acquires the mutex, waits while another process holds it
+void os_mutexLock(Mutex* mutex);
+
+//! Acquires the mutex if it is free, never waits
+bool os_mutexTryLock(Mutex* mutex);
+
+//! Releases the mutex or hands it to the first waiting process
+void os_mutexUnlock(Mutex* mutex);
+
+//! Removes a process that is about to be killed from all synchronization objects
+void os_syncCleanup(ProcessID pid);
+
+//! Sets the priority a process was given, inherited priorities stay in effect
+void os_setBasePriority(ProcessID pid, Priority priority);
+
+//! Recalculates the effective priority of a process from its base and its waiters
+void os_syncUpdatePriority(ProcessID pid);
+
+//! The current process waits for a shared chunk the holders of which inherit its priority
+void os_syncChunkWait(Heap const* heap, MemAddr chunk);
+
+//! The current process opened a shared chunk (and stops waiting for it)
+void os_syncChunkOpened(Heap const* heap, MemAddr chunk);
+
+//! The current process closed a shared chunk
+void os_syncChunkClosed(Heap const* heap, MemAddr chunk);
+
+#endif
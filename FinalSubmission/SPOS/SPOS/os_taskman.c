@@ -45,7 +45,8 @@ Page specification;
 #pragma GCC optimize ("O3")
 
 Process* os_getProcessSlot(ProcessID);
-Program** os_getProgramSlot(ProgramID);
+Program* os_lookupProgramFunction(ProgramID);
+void os_setBasePriority(ProcessID, Priority);
 
 /* END OF INTERFACE DECLS ************************/
 
@@ -80,11 +81,41 @@ Program** os_getProgramSlot(ProgramID);
  */
 #define TM_COMPILE_HEAP_SUPPORT (VERSUCH >= 3)
 
+/*!
+ *  Does the OS keep track of how much stack each process has used?
+ */
+#define TM_COMPILE_STACK_SUPPORT (VERSUCH >= 3)
+
+/*!
+ *  Does the OS know periodic processes and their deadlines?
+ */
+#define TM_COMPILE_PERIODIC_SUPPORT (VERSUCH >= 5)
+
+/*!
+ *  Does the OS account CPU time and scheduling latency per process?
+ */
+#define TM_COMPILE_STATS_SUPPORT (VERSUCH >= 2)
+
+/*!
+ *  Can the tick period and the quantum of the strategies be changed at runtime?
+ */
+#define TM_COMPILE_TICK_SUPPORT (VERSUCH >= 2)
+
+/*!
+ *  Can processes be limited to a CPU budget?
+ */
+#define TM_COMPILE_BUDGET_SUPPORT (VERSUCH >= 2)
+
+/*!
+ *  Does the OS measure its latencies with Timer 1 (see OS_MEASURE)?
+ */
+#define TM_COMPILE_MEASURE_SUPPORT (OS_MEASURE)
+
 /*!
  *  The number of main-pages of the TM. Actually, this is set by
  *  the respective page-handler at runtime.
  */
-#define TM_MAINPAGES 8
+#define TM_MAINPAGES 13
 
 /*!
  *  How many heaps should the TM maximally support. This is
@@ -97,6 +128,7 @@ Program** os_getProgramSlot(ProgramID);
  *  When dumping the map of any heap, this define specifies how many
  *  map-entries should be visible at a time. Be careful when changing this
  *  constant, as it may lead to display overruns if set too high (or odd).
+ *  Heaps with a byte-wide map show half as many entries.
  */
 #define TM_MAP_ENTRIES_PER_PAGE 20
 
@@ -439,7 +471,14 @@ char PROGMEM const mainLabels[] =
     "Kill Process                   \0"
     "Change Priority                \0"
     "Change Scheduling Strategy     \0"
-    "Heap(s)                        \0";
+    "Heap(s)                        \0"
+    "Stack Usage                    \0"
+    "Periodic Tasks                 \0"
+    "CPU & Latency                  \0"
+    "Tick Period                    \0"
+    "Strategy Quantum               \0"
+    "CPU Budgets                    \0"
+    "Kernel Latency                 \0";
 
 // Forward declarations for the sub-pages of the root-page.
 static tm_page tm_frontpage;
@@ -461,6 +500,46 @@ static tm_page tm_startProg;
     static tm_page tm_heap;
 #endif
 
+#if TM_COMPILE_STACK_SUPPORT
+    static tm_page tm_stack;
+#endif
+
+#if TM_COMPILE_PERIODIC_SUPPORT
+    static tm_page tm_periodic;
+#endif
+
+#if TM_COMPILE_STATS_SUPPORT
+    static tm_page tm_stats;
+#endif
+
+#if TM_COMPILE_TICK_SUPPORT
+    static tm_page tm_tick;
+    static tm_page tm_quantum;
+
+    //! Tick periods (in us) the task manager offers
+    static uint16_t const tickPresets[] PROGMEM = { 500, 1000, 2000, 3000, 5000, 10000 };
+    #define TICK_PRESET_COUNT (sizeof(tickPresets) / sizeof(tickPresets[0]))
+
+    //! Longest quantum (in ticks) the task manager offers
+    #define QUANTUM_MAX 16
+#endif
+
+#if TM_COMPILE_BUDGET_SUPPORT
+    static tm_page tm_budget;
+#endif
+
+#if TM_COMPILE_MEASURE_SUPPORT
+    static tm_page tm_measure;
+
+    //! Short names of the measured kernel paths (see MeasureCategory)
+    static char const measureLabels[] PROGMEM =
+        "Tick\0"
+        "Swch\0"
+        "Disp\0"
+        "Prmt\0"
+        "Irq \0";
+#endif
+
 static tm_page tm_null;
 
 // A convenience macro to access the stack-history.
@@ -472,6 +551,8 @@ static tm_page tm_null;
 #define MAX4(Xa,X3...) (MAX2(Xa,(MAX3(X3))))
 #define MAX5(Xa,X4...) (MAX2(Xa,(MAX4(X4))))
 #define MAX6(Xa,X5...) (MAX2(Xa,(MAX5(X5))))
+#define MAX7(Xa,X6...) (MAX2(Xa,(MAX6(X6))))
+#define MAX8(Xa,X7...) (MAX2(Xa,(MAX7(X7))))
 
 #if TM_COMPILE_SCHEDULING_SUPPORT
     /*!
@@ -482,7 +563,7 @@ static tm_page tm_null;
      *     Gaps are no problem for the TM engine.
      */
     #if VERSUCH >= 5
-        #define SS_MAX_COUNT (MAX6(OS_SS_RUN_TO_COMPLETION, OS_SS_RANDOM, OS_SS_EVEN, OS_SS_ROUND_ROBIN, OS_SS_INACTIVE_AGING, OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE) + 1)
+        #define SS_MAX_COUNT (MAX8(OS_SS_RUN_TO_COMPLETION, OS_SS_RANDOM, OS_SS_EVEN, OS_SS_ROUND_ROBIN, OS_SS_INACTIVE_AGING, OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE, OS_SS_EDF, OS_SS_STRIDE) + 1)
     #else
         #define SS_MAX_COUNT (MAX5(OS_SS_RUN_TO_COMPLETION, OS_SS_RANDOM, OS_SS_EVEN, OS_SS_ROUND_ROBIN, OS_SS_INACTIVE_AGING) + 1)
     #endif
@@ -527,6 +608,25 @@ static TM_PAGE(tm_rootpage) {
 #if TM_COMPILE_HEAP_SUPPORT
         SUBP(5, tm_heap, 0, TM_HEAP_SUPPORT)
 #endif
+#if TM_COMPILE_STACK_SUPPORT
+        SUBP(6, tm_stack, os_getCurrentProc(), MAX_NUMBER_OF_PROCESSES)
+#endif
+#if TM_COMPILE_PERIODIC_SUPPORT
+        SUBP(7, tm_periodic, 0, MAX_NUMBER_OF_PROCESSES)
+#endif
+#if TM_COMPILE_STATS_SUPPORT
+        SUBP(8, tm_stats, os_getCurrentProc(), MAX_NUMBER_OF_PROCESSES)
+#endif
+#if TM_COMPILE_TICK_SUPPORT
+        SUBP(9, tm_tick, 0, TICK_PRESET_COUNT)
+        SUBP(10, tm_quantum, os_getStrategyQuantum(os_getSchedulingStrategy()) - 1, QUANTUM_MAX)
+#endif
+#if TM_COMPILE_BUDGET_SUPPORT
+        SUBP(11, tm_budget, os_getCurrentProc(), MAX_NUMBER_OF_PROCESSES)
+#endif
+#if TM_COMPILE_MEASURE_SUPPORT
+        SUBP(12, tm_measure, 0, MEASURE_CATEGORY_COUNT)
+#endif
 #undef SUBP
         default:
             result->child.call = tm_null;
@@ -647,7 +747,7 @@ make_pagehandler(tm_frontpage, tm_null, 0, 0, OS_PR_FRONTPAGE, null, 0) {
  */
 make_pagehandler(tm_startProg, tm_startProg_exec, 0, 1, OS_PR_START_PROG_SELECT, null, 0) {
     uint16_t const page = peekStack(0).param;
-    if (!*os_getProgramSlot(page)) {
+    if (!os_lookupProgramFunction(page)) {
         return false;
     }
     lcd_writeProgString(PSTR("Start prog $"));
@@ -656,7 +756,7 @@ make_pagehandler(tm_startProg, tm_startProg_exec, 0, 1, OS_PR_START_PROG_SELECT,
     lcd_writeDec(os_getNumberOfRegisteredPrograms());
     lcd_line2();
     lcd_writeProgString(PSTR(" @"));
-    lcd_writeHexWord((uint16_t)(*os_getProgramSlot(page)));
+    lcd_writeHexWord((uint16_t)os_lookupProgramFunction(page));
     return true;
 }
 
@@ -870,9 +970,9 @@ make_pagehandler(tm_priority_changeL, tm_priority_set, 0, 1, OS_PR_PRIORITY, nul
  */
 make_pagehandler(tm_priority_set, tm_null, 0, 0, OS_PR_PRIORITY, pid, peekStack(4).param) {
     lcd_writeProgString(PSTR("Setting priority"));
-    os_getProcessSlot(peekStack(4).param)->priority
-        = ((peekStack(2).param & 0xF) << 4)
-          + ((peekStack(1).param & 0xF));
+    os_setBasePriority(peekStack(4).param,
+        ((peekStack(2).param & 0xF) << 4)
+          + ((peekStack(1).param & 0xF)));
     tm_done();
     lcd_writeProgString(PSTR(", now: "));
     lcd_writeHexByte(os_getProcessSlot(peekStack(4).param)->priority);
@@ -1002,6 +1102,8 @@ makeStrategyNameLookup(getSchedulingStratNames, 0x18, 0,
     {OS_SS_INACTIVE_AGING,            PSTR("<Inactive Aging>       ")},
     #if VERSUCH >= 5
     {OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE, PSTR("<MLFQ>                 ")},
+    {OS_SS_EDF,                       PSTR("<Earliest Deadline>    ")},
+    {OS_SS_STRIDE,                    PSTR("<Stride>               ")},
     #endif
 )
 
@@ -1036,7 +1138,7 @@ static char const* getHeapName(uint8_t ram) {
 /*!
  *  The page to select which heap to inspect. Supports NULL-heaps.
  */
-make_pagehandler(tm_heap, tm_heap2, 0, 4, OS_PR_SHOW_HEAP, heapId, peekStack(0).param) {
+make_pagehandler(tm_heap, tm_heap2, 0, 5, OS_PR_SHOW_HEAP, heapId, peekStack(0).param) {
     uint16_t const ram = peekStack(0).param;
     if (ram >= os_getHeapListLength() || !os_lookupHeap(ram)) {
         return false;
@@ -1053,6 +1155,11 @@ static tm_page tm_heap_contents;
 static tm_page tm_heap_chunks;
 static tm_page tm_heap_erase;
 
+//! Number of map entries the map dump shows per page of the passed heap.
+static uint8_t mapEntriesPerPage(Heap const* heap) {
+    return heap->mapFormat == OS_MAP_BYTE ? TM_MAP_ENTRIES_PER_PAGE / 2 : TM_MAP_ENTRIES_PER_PAGE;
+}
+
 /*!
  *  The page to select what to do with a previously selected heap.
  *  The current options are:
@@ -1060,6 +1167,7 @@ static tm_page tm_heap_erase;
  *   - dump the map
  *   - browse chunks
  *   - erase everything
+ *   - show the map format and its overhead
  */
 make_pagehandler(tm_heap2, tm_heap_strategy, 0, MS_MAX_COUNT, OS_PR_ALWAYS_ALLOW, null, 0) {
     Heap* const heap = os_lookupHeap(peekStack(1).param);
@@ -1073,7 +1181,7 @@ make_pagehandler(tm_heap2, tm_heap_strategy, 0, MS_MAX_COUNT, OS_PR_ALWAYS_ALLOW
             lcd_writeProgString(PSTR("Map content dump"));
             result->call = tm_heap_contents;
             result->param = 0;
-            result->range = (os_getUseSize(heap) + TM_MAP_ENTRIES_PER_PAGE - 1) / TM_MAP_ENTRIES_PER_PAGE;
+            result->range = (os_getUseSize(heap) + mapEntriesPerPage(heap) - 1) / mapEntriesPerPage(heap);
             break;
         }
         case 2: {
@@ -1090,6 +1198,14 @@ make_pagehandler(tm_heap2, tm_heap_strategy, 0, MS_MAX_COUNT, OS_PR_ALWAYS_ALLOW
             result->range = 1;
             break;
         }
+        case 4: {
+            lcd_writeProgString(heap->mapFormat == OS_MAP_BYTE ? PSTR("Byte map ") : PSTR("Nibble map "));
+            lcd_writeDec(os_getMapOverhead(heap));
+            lcd_writeChar('%');
+            // nothing to select here
+            result->call = 0;
+            break;
+        }
         default:
             return false;
     }
@@ -1128,6 +1244,9 @@ make_pagehandler(tm_heap_strategy_set, tm_null, 0, 0, OS_PR_ALLOCATION, as, peek
 
 static MemValue derefMap(Heap const* heap, MemAddr usePtr) {
     uint16_t const uOff = usePtr - os_getUseStart(heap);
+    if (heap->mapFormat == OS_MAP_BYTE) {
+        return heap->driver->read(os_getMapStart(heap) + uOff);
+    }
     return (heap->driver->read(os_getMapStart(heap) + uOff / 2) >> (((~uOff) & 1) << 2)) & 0xF;
 }
 
@@ -1136,14 +1255,19 @@ static MemValue derefMap(Heap const* heap, MemAddr usePtr) {
  */
 make_pagehandler(tm_heap_contents, tm_null, 0, 0, OS_PR_SHOW_HEAP, null, 0) {
     Heap* const heap = os_lookupHeap(peekStack(2).param);
-    uint16_t addr = os_getUseStart(heap) + peekStack(0).param *  TM_MAP_ENTRIES_PER_PAGE;
+    uint16_t addr = os_getUseStart(heap) + peekStack(0).param * mapEntriesPerPage(heap);
+    uint8_t const perLine = mapEntriesPerPage(heap) / 2;
     uint8_t i, j;
     for (i = 0; i < 2; i++) {
         lcd_writeHexWord(addr);
         lcd_writeProgString(PSTR(": "));
-        for (j = 0; j < 16 - 6; j++)
+        for (j = 0; j < perLine; j++)
             if (addr < os_getUseStart(heap) + os_getUseSize(heap)) {
-                lcd_writeHexNibble(derefMap(heap, addr++));
+                if (heap->mapFormat == OS_MAP_BYTE) {
+                    lcd_writeHexByte(derefMap(heap, addr++));
+                } else {
+                    lcd_writeHexNibble(derefMap(heap, addr++));
+                }
             } else {
                 i = j = 16;
             }
@@ -1155,20 +1279,24 @@ make_pagehandler(tm_heap_contents, tm_null, 0, 0, OS_PR_SHOW_HEAP, null, 0) {
  *  The page to display distinct chunks of the heap.
  *  This page will not work correctly with different heap-map specifications
  *  you are free to remove or modify this in case the heap-map semantics are
- *  changed.
+ *  changed. Shared chunks are marked with '*', the others with '#'.
  */
 make_pagehandler(tm_heap_chunks, tm_null, 0, 0, OS_PR_SHOW_HEAP, null, 0) {
     Heap* const heap = os_lookupHeap(peekStack(2).param);
     uint16_t const addr = os_getUseStart(heap) + peekStack(0).param;
     MemValue const owner = derefMap(heap, addr);
-    if (owner == 0 || owner == 0xF) {
+    if (owner == 0 || owner == os_getMapContinuationValue(heap)) {
         return false;
     }
     lcd_writeProgString(PSTR("Chunk @"));
     lcd_writeHexWord(addr);
     lcd_writeProgString(PSTR(" ("));
-    lcd_writeChar((owner < MAX_NUMBER_OF_PROCESSES) ? '#' : '*');
-    lcd_writeHexNibble(owner);
+    lcd_writeChar((owner < os_getMapSharedValue(heap)) ? '#' : '*');
+    if (heap->mapFormat == OS_MAP_BYTE) {
+        lcd_writeHexByte(owner);
+    } else {
+        lcd_writeHexNibble(owner);
+    }
     lcd_writeChar(')');
     lcd_line2();
     lcd_writeProgString(PSTR("Length: ..."));
@@ -1214,4 +1342,257 @@ make_pagehandler(tm_heap_erase2, tm_null, 0, 0, OS_PR_ERASE_HEAP, heapId, peekSt
 
 #endif
 
+#if TM_COMPILE_STACK_SUPPORT
+
+/*!
+ *  Shows the stack high-water mark of every process next to the size of its
+ *  stack. Unused slots are skipped.
+ */
+make_pagehandler(tm_stack, tm_null, 0, 0, OS_PR_ALWAYS_ALLOW, null, 0) {
+    uint16_t const page = peekStack(0).param;
+    Process const* const proc = os_getProcessSlot(page);
+    if (proc->state == OS_PS_UNUSED) {
+        return false;
+    }
+    lcd_writeProgString(PSTR("Stack #"));
+    lcd_writeDec(page);
+    lcd_writeProgString(PSTR(" ($"));
+    lcd_writeDec(proc->progID);
+    lcd_writeChar(')');
+    lcd_line2();
+    lcd_writeProgString(PSTR("used "));
+    lcd_writeDec(os_getStackHighWater(page));
+    lcd_writeChar('/');
+    lcd_writeDec(proc->stackSize);
+    return true;
+}
+
+#endif
+
+#if TM_COMPILE_PERIODIC_SUPPORT
+
+//! Converts Timer 0 overflows to ms for display
+static uint16_t rawToMs(uint16_t raw) {
+    return ((uint32_t)raw * 1000ul) / TIME_RAW_PER_S;
+}
+
+/*!
+ *  Shows period and relative deadline of every periodic process, the number
+ *  of missed jobs and the release jitter (spread of the time from release to
+ *  job start). Processes that are not periodic are skipped.
+ */
+make_pagehandler(tm_periodic, tm_null, 0, 0, OS_PR_ALWAYS_ALLOW, null, 0) {
+    uint16_t const page = peekStack(0).param;
+    PeriodicInfo const* const info = os_getPeriodicInfo(page);
+    if (os_getProcessSlot(page)->state == OS_PS_UNUSED || info->period == 0) {
+        return false;
+    }
+    lcd_writeChar('#');
+    lcd_writeDec(page);
+    lcd_writeProgString(PSTR(" P"));
+    lcd_writeDec(rawToMs(info->period));
+    lcd_writeProgString(PSTR(" D"));
+    lcd_writeDec(rawToMs(info->relDeadline));
+    lcd_line2();
+    lcd_writeProgString(PSTR("X"));
+    lcd_writeDec(info->misses);
+    lcd_writeChar('/');
+    lcd_writeDec(info->jobs);
+    lcd_writeProgString(PSTR(" J"));
+    lcd_writeDec(info->maxLatency >= info->minLatency ? rawToMs(info->maxLatency - info->minLatency) : 0);
+    lcd_writeProgString(PSTR("ms"));
+    return true;
+}
+
+#endif
+
+#if TM_COMPILE_STATS_SUPPORT
+
+//! Converts Timer 0 ticks to us for display (saturates at 65535)
+static uint16_t ticksToUs(Time ticks) {
+    Time const us = TIME_TICKS_TO_US(ticks);
+    return us > UINT16_MAX ? UINT16_MAX : us;
+}
+
+/*!
+ *  Shows the CPU load of every process, how often it was preempted and
+ *  dispatched and the average and maximum time from ready to running.
+ *  Unused slots are skipped.
+ */
+make_pagehandler(tm_stats, tm_null, 0, 0, OS_PR_ALWAYS_ALLOW, null, 0) {
+    uint16_t const page = peekStack(0).param;
+    if (os_getProcessSlot(page)->state == OS_PS_UNUSED) {
+        return false;
+    }
+    ProcessStats const* const stats = os_getProcessStats(page);
+    lcd_writeChar('#');
+    lcd_writeDec(page);
+    lcd_writeChar(' ');
+    lcd_writeDec(os_getCpuLoad(page));
+    lcd_writeProgString(PSTR("% P"));
+    lcd_writeDec(stats->preemptions);
+    lcd_writeChar('/');
+    lcd_writeDec(stats->dispatches);
+    lcd_line2();
+    lcd_writeProgString(PSTR("Lat "));
+    lcd_writeDec(stats->dispatches ? ticksToUs(stats->latencySum / stats->dispatches) : 0);
+    lcd_writeChar('/');
+    lcd_writeDec(ticksToUs(stats->maxLatency));
+    lcd_writeProgString(PSTR("us"));
+    return true;
+}
+
+#endif
+
+#if TM_COMPILE_TICK_SUPPORT
+
+/*!
+ *  The page to select one of the offered tick periods.
+ */
+make_pagehandler(tm_tick, tm_tick_set, 0, 0, OS_PR_ALWAYS_ALLOW, null, 0) {
+    uint16_t const us = pgm_read_word(&tickPresets[peekStack(0).param]);
+    lcd_writeProgString(PSTR("Tick "));
+    lcd_writeDec(us);
+    lcd_writeProgString(PSTR("us"));
+    lcd_line2();
+    if (us == os_getTickPeriod()) {
+        lcd_writeProgString(PSTR("(current)"));
+    } else {
+        lcd_writeProgString(PSTR("set?"));
+    }
+    return true;
+}
+
+/*!
+ *  The page to set a previously selected tick period.
+ */
+make_pagehandler(tm_tick_set, tm_null, 0, 0, OS_PR_ALWAYS_ALLOW, null, 0) {
+    uint16_t const us = pgm_read_word(&tickPresets[peekStack(1).param]);
+    lcd_writeProgString(PSTR("Tick "));
+    lcd_writeDec(us);
+    lcd_writeProgString(PSTR("us"));
+    if (os_setTickPeriod(us)) {
+        tm_done();
+    } else {
+        tm_fail();
+    }
+    return true;
+}
+
+/*!
+ *  The page to select the quantum (in ticks) of the active scheduling strategy.
+ */
+make_pagehandler(tm_quantum, tm_quantum_set, 0, 0, OS_PR_ALWAYS_ALLOW, null, 0) {
+    uint16_t const ticks = peekStack(0).param + 1;
+    lcd_writeProgString(PSTR("Quantum "));
+    lcd_writeDec(ticks);
+    lcd_writeProgString(PSTR(" ticks"));
+    lcd_line2();
+    if (ticks == os_getStrategyQuantum(os_getSchedulingStrategy())) {
+        lcd_writeProgString(PSTR("(current)"));
+    } else {
+        lcd_writeProgString(PSTR("set?"));
+    }
+    return true;
+}
+
+/*!
+ *  The page to set a previously selected quantum for the active scheduling strategy.
+ */
+make_pagehandler(tm_quantum_set, tm_null, 0, 0, OS_PR_ALWAYS_ALLOW, null, 0) {
+    uint16_t const ticks = peekStack(1).param + 1;
+    lcd_writeProgString(PSTR("Quantum "));
+    lcd_writeDec(ticks);
+    os_setStrategyQuantum(os_getSchedulingStrategy(), ticks);
+    tm_done();
+    return true;
+}
+
+#endif
+
+#if TM_COMPILE_BUDGET_SUPPORT
+
+/*!
+ *  Shows the CPU budget of every process (ticks per window), the ticks used
+ *  in the current window and how often the process was throttled. Unused
+ *  slots are skipped.
+ */
+make_pagehandler(tm_budget, tm_null, 0, 0, OS_PR_ALWAYS_ALLOW, null, 0) {
+    uint16_t const page = peekStack(0).param;
+    Process const* const proc = os_getProcessSlot(page);
+    if (proc->state == OS_PS_UNUSED) {
+        return false;
+    }
+    CpuBudget const* const budget = os_getCpuBudget(page);
+    lcd_writeChar('#');
+    lcd_writeDec(page);
+    lcd_writeChar(' ');
+    if (budget->ticks) {
+        lcd_writeDec(budget->ticks);
+        lcd_writeChar('/');
+        lcd_writeDec(budget->window);
+        lcd_writeProgString(PSTR(" ticks"));
+    } else {
+        lcd_writeProgString(PSTR("no budget"));
+    }
+    lcd_line2();
+    lcd_writeProgString(PSTR("Thr "));
+    lcd_writeDec(budget->throttles);
+    if (proc->state == OS_PS_THROTTLED) {
+        lcd_writeProgString(PSTR(" (now)"));
+    }
+    return true;
+}
+
+#endif
+
+#if TM_COMPILE_MEASURE_SUPPORT
+
+/*!
+ *  Shows minimum, average and maximum duration (in us) of a measured kernel
+ *  path and its histogram: one digit per bucket (see MEASURE_BUCKETS), from
+ *  0 for an empty bucket to 9 for the fullest one, followed by the number of
+ *  samples. ENTER clears the statistics of all paths.
+ */
+make_pagehandler(tm_measure, tm_measure_reset, 0, 0, OS_PR_ALWAYS_ALLOW, null, 0) {
+    MeasureStats const* const stats = os_getMeasureStats(peekStack(0).param);
+    lcd_writeProgString(measureLabels + 5 * peekStack(0).param);
+    lcd_writeChar(' ');
+    if (stats->count) {
+        lcd_writeDec(MEASURE_TICKS_TO_US(stats->min));
+        lcd_writeChar('/');
+        lcd_writeDec(MEASURE_TICKS_TO_US(stats->sum / stats->count));
+        lcd_writeChar('/');
+        lcd_writeDec(MEASURE_TICKS_TO_US(stats->max));
+    } else {
+        lcd_writeProgString(PSTR("no samples"));
+    }
+    lcd_line2();
+    uint16_t fullest = 1;
+    for (uint8_t i = 0; i < MEASURE_BUCKETS; i++) {
+        if (stats->buckets[i] > fullest) {
+            fullest = stats->buckets[i];
+        }
+    }
+    for (uint8_t i = 0; i < MEASURE_BUCKETS; i++) {
+        uint16_t const n = stats->buckets[i];
+        lcd_writeChar('0' + (n ? 1 + (uint32_t)n * 8 / fullest : 0));
+    }
+    lcd_writeChar(' ');
+    lcd_writeDec(stats->count);
+    return true;
+}
+
+/*!
+ *  The page to clear the latency statistics.
+ */
+make_pagehandler(tm_measure_reset, tm_null, 0, 0, OS_PR_ALWAYS_ALLOW, null, 0) {
+    lcd_writeProgString(PSTR("Latencies"));
+    os_measureReset();
+    tm_done();
+    return true;
+}
+
+#endif
+
 #pragma GCC pop_options
\ No newline at end of file
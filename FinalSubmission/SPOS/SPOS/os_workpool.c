@@ -0,0 +1,181 @@
+#include "os_workpool.h"
+#include "os_scheduler.h"
+
+//----------------------------------------------------------------------------
+// Private variables
+//----------------------------------------------------------------------------
+
+//! Ring buffer of the queued jobs
+static Job* workQueue[WORKPOOL_QUEUE_SIZE];
+
+//! Slot of the oldest queued job
+static uint8_t workHead = 0;
+
+//! Slot the next job is queued in
+static uint8_t workTail = 0;
+
+//! Number of queued jobs no worker took yet
+static uint8_t workPending = 0;
+
+//! Counts the free slots of the queue, submitters wait for it
+static Semaphore workFree = SEMAPHORE_INIT(WORKPOOL_QUEUE_SIZE);
+
+//! Counts the queued jobs, idle workers wait for it
+static Semaphore workQueued = SEMAPHORE_INIT(0);
+
+//! Number of finished jobs
+static uint16_t workCompleted = 0;
+
+//! Number of jobs os_trySubmit rejected
+static uint16_t workRejected = 0;
+
+//----------------------------------------------------------------------------
+// Private functions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Puts a job into the slot the caller reserved via workFree and hands it to
+ *  the workers via workQueued.
+ */
+static void os_workpoolPut(Job* job, WorkProc* proc, void* arg) {
+	job->proc = proc;
+	job->arg = arg;
+	job->done = false;
+	os_semInit(&job->finished, 0);
+
+	os_enterCriticalSection();
+	workQueue[workTail] = job;
+	if (++workTail == WORKPOOL_QUEUE_SIZE) {
+		workTail = 0;
+	}
+	workPending++;
+	os_leaveCriticalSection();
+	os_semSignal(&workQueued);
+}
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Starts worker processes. The program must be defined with
+ *  WORKPOOL_WORKER. Workers run until they are killed, a worker that is
+ *  killed while running a job loses the job.
+ *
+ *  \param worker The program defined with WORKPOOL_WORKER.
+ *  \param count Number of workers to start.
+ *  \param priority Priority of the workers.
+ *  \return Number of workers that were started (less if the process slots ran out).
+ */
+uint8_t os_workpoolStart(ProgramID worker, uint8_t count, Priority priority) {
+	uint8_t started = 0;
+	while (started < count && os_exec(worker, priority) != INVALID_PROCESS) {
+		started++;
+	}
+	return started;
+}
+
+/*!
+ *  Takes the oldest job from the queue, runs it and signals its completion,
+ *  forever. The job runs in the worker process, so it may wait, sleep and use
+ *  the heaps like any process.
+ */
+void os_workerMain(void) {
+	while (1) {
+		os_semWait(&workQueued);
+
+		os_enterCriticalSection();
+		Job* const job = workQueue[workHead];
+		if (++workHead == WORKPOOL_QUEUE_SIZE) {
+			workHead = 0;
+		}
+		workPending--;
+		os_leaveCriticalSection();
+		os_semSignal(&workFree);
+
+		job->proc(job->arg);
+
+		// Once done is set, a poller may reuse the job, so it is set last
+		// and the job must not be touched afterwards
+		os_enterCriticalSection();
+		workCompleted++;
+		os_semSignal(&job->finished);
+		job->done = true;
+		os_leaveCriticalSection();
+	}
+}
+
+/*!
+ *  Queues a job. While the queue is full, the calling process waits for a
+ *  worker to take a job.
+ *
+ *  \param job Memory for the job and its completion handle.
+ *  \param proc The procedure to run.
+ *  \param arg The argument passed to the procedure.
+ */
+void os_submit(Job* job, WorkProc* proc, void* arg) {
+	os_semWait(&workFree);
+	os_workpoolPut(job, proc, arg);
+}
+
+/*!
+ *  Queues a job if the queue has room.
+ *
+ *  \param job Memory for the job and its completion handle.
+ *  \param proc The procedure to run.
+ *  \param arg The argument passed to the procedure.
+ *  \return False if the queue is full (the job is not queued).
+ */
+bool os_trySubmit(Job* job, WorkProc* proc, void* arg) {
+	if (!os_semTryWait(&workFree)) {
+		os_enterCriticalSection();
+		workRejected++;
+		os_leaveCriticalSection();
+		return false;
+	}
+	os_workpoolPut(job, proc, arg);
+	return true;
+}
+
+/*!
+ *  Waits until a worker finished the job. Only one process may wait for a
+ *  job, and only once. Use job->done to poll instead.
+ *
+ *  \param job A job that was queued by os_submit or os_trySubmit.
+ */
+void os_await(Job* job) {
+	os_semWait(&job->finished);
+}
+
+/*!
+ *  Returns the number of queued jobs that no worker took yet.
+ *
+ *  \return The number of pending jobs.
+ */
+uint8_t os_getWorkpoolPending(void) {
+	return workPending;
+}
+
+/*!
+ *  Returns how many jobs the workers finished since the start.
+ *
+ *  \return The number of finished jobs.
+ */
+uint16_t os_getWorkpoolCompleted(void) {
+	os_enterCriticalSection();
+	uint16_t const completed = workCompleted;
+	os_leaveCriticalSection();
+	return completed;
+}
+
+/*!
+ *  Returns how many jobs os_trySubmit rejected because the queue was full.
+ *
+ *  \return The number of rejected jobs.
+ */
+uint16_t os_getWorkpoolRejected(void) {
+	os_enterCriticalSection();
+	uint16_t const rejected = workRejected;
+	os_leaveCriticalSection();
+	return rejected;
+}
@@ -0,0 +1,80 @@
+/*! \file
+ *  \brief Worker pool that runs jobs on a fixed set of processes.
+ *
+ *  A job is a procedure and an argument. os_submit appends it to a bounded
+ *  queue, and the first idle worker process runs it. So a job costs no
+ *  process slot and no stack setup. A full queue is back-pressure: os_submit
+ *  waits for room and os_trySubmit fails, instead of os_exec returning
+ *  INVALID_PROCESS.
+ *
+ *  The workers are processes of a program that the application defines with
+ *  WORKPOOL_WORKER, e.g. WORKPOOL_WORKER(7); os_workpoolStart(7, 3, ...).
+ */
+
+#ifndef _OS_WORKPOOL_H
+#define _OS_WORKPOOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "defines.h"
+#include "os_process.h"
+#include "os_sync.h"
+
+//----------------------------------------------------------------------------
+// Types
+//----------------------------------------------------------------------------
+
+//! This is the type of a job procedure (not the pointer to one!).
+typedef void WorkProc(void* arg);
+
+//! A job and its completion handle, the memory has to stay valid until os_await returned
+typedef struct Job {
+	WorkProc* proc;
+	void* arg;
+	volatile bool done;     //!< Set once the procedure returned
+	Semaphore finished;     //!< Signaled once the procedure returned
+} Job;
+
+//----------------------------------------------------------------------------
+// Macros
+//----------------------------------------------------------------------------
+
+//! Defines the program of the worker processes
+#define WORKPOOL_WORKER(INDEX) WORKPOOL_WORKER_EX(INDEX, 0)
+
+//! Defines the program of the worker processes with the passed stack size (0: STACK_SIZE_PROC)
+#define WORKPOOL_WORKER_EX(INDEX, STACK) \
+    PROGRAM_EX(INDEX, DONTSTART, STACK, DEFAULT_PRIORITY) { \
+        os_workerMain(); \
+    }
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! Starts worker processes of the passed program and returns how many could be started
+uint8_t os_workpoolStart(ProgramID worker, uint8_t count, Priority priority);
+
+//! Main loop of a worker process, only called by WORKPOOL_WORKER
+void os_workerMain(void);
+
+//! Queues a job, waits while the queue is full
+void os_submit(Job* job, WorkProc* proc, void* arg);
+
+//! Queues a job if there is room, never waits
+bool os_trySubmit(Job* job, WorkProc* proc, void* arg);
+
+//! Waits until a job is done
+void os_await(Job* job);
+
+//! Returns the number of queued jobs no worker took yet
+uint8_t os_getWorkpoolPending(void);
+
+//! Returns the number of jobs that were finished since the start
+uint16_t os_getWorkpoolCompleted(void);
+
+//! Returns the number of jobs os_trySubmit rejected because the queue was full
+uint16_t os_getWorkpoolRejected(void);
+
+#endif
@@ -47,12 +47,27 @@ Time os_systemTime_coarse(void) {
     return os_systemTime_overflows * 1000 / (F_CPU/TC0_PRESCALER/256);
 } 
 
+/*!
+ * Function that returns the number of Timer 0 overflows since the last reset. This is the cheapest
+ * clock of the system (no multiplication or division) and is used for kernel timers.
+ *
+ * \return The system time in units of Timer 0 overflows (~3.3 ms)
+ */
+Time os_systemTime_raw(void) {
+    // same as in os_systemTime_augment: account for an overflow that the ISR could not handle yet
+    if ((!(SREG & (1<<7))) && (TIFR0 & (1<<TOV0))) {
+        TIFR0 |= (1<<TOV0);
+        os_systemTime_overflows++;
+    }
+    return os_systemTime_overflows;
+}
+
 /*!
  * Function augments os_systemTime_overflows to increase precision to approx 13 us (presc/f_cpu = 256/20MHz)
  *
  * \return os_systemTime_overflows scaled by cpu speed , timer prescaler as well as register size
  */
-static Time os_systemTime_augment(void) {
+Time os_systemTime_augment(void) {
     /*! in case Interrupts are off and the overflow flag is activated we simulate the overflow interrupt.
      *  The flag signalizes, that an overflow occurred. This would have been handled by the ISR immediately
      *  but since the interrupts are off, the controller will wait until they come back on. However,
@@ -15,6 +15,10 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <avr/pgmspace.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "os_measure.h"
 
 typedef uint32_t Time;
 
@@ -33,6 +37,12 @@ Time os_systemTime_coarse(void);
 //! Precise system time in ms
 Time os_systemTime_precise(void);
 
+//! System time in Timer 0 overflows (~3.3 ms each)
+Time os_systemTime_raw(void);
+
+//! System time in Timer 0 ticks (~13 us each)
+Time os_systemTime_augment(void);
+
 //! Waits for some milliseconds
 void delayMs(Time ms);
 
@@ -42,6 +52,36 @@ bool assertPstr(bool exp, char const* errormsg);
 //! Handy define to specify assert calls directly (without PSTR(..)) 
 #define assert(exp,errormsg) assertPstr(exp, PSTR(errormsg))
 
+/*!
+ *  Disables all interrupts for a short access to hardware or to data that
+ *  interrupt handlers share, e.g. a register sequence that must not be split.
+ *  Keep these sections to a few instructions, they add to the interrupt
+ *  latency of the whole system. Use os_preemptDisable for anything longer.
+ *
+ *  \return The state to pass to os_irqRestore.
+ */
+static inline uint8_t os_irqSave(void) {
+    uint8_t const sreg = SREG;
+    cli();
+#if OS_MEASURE
+    if (sreg & (1 << 7)) {
+        measureIrqStart = TCNT1;
+    }
+#endif
+    return sreg;
+}
+
+//! Restores the interrupt state that os_irqSave returned
+static inline void os_irqRestore(uint8_t sreg) {
+    __asm__ volatile ("" ::: "memory");
+#if OS_MEASURE
+    if (sreg & (1 << 7)) {
+        os_measureRecord(OS_MC_IRQ_OFF, TCNT1 - measureIrqStart);
+    }
+#endif
+    SREG = sreg;
+}
+
 //----------------------------------------------------------------------------
 // Macros
 //----------------------------------------------------------------------------
@@ -60,6 +100,16 @@ bool assertPstr(bool exp, char const* errormsg);
 #define TIME_M_TO_MS(m)     (TIME_S_TO_MS(m *  60ul))
 #define TIME_H_TO_MS(h)     (TIME_M_TO_MS(h *  60ul))
 
+//! Number of Timer 0 overflows per second (see os_systemTime_raw)
+#define TIME_RAW_PER_S      (F_CPU/TC0_PRESCALER/256)
+
+//! Converts ms to Timer 0 overflows, rounding up (valid up to TIME_MS_TO_RAW_MAX)
+#define TIME_MS_TO_RAW(ms)  (((ms) * TIME_RAW_PER_S + 999ul) / 1000ul)
+#define TIME_TICKS_TO_US(t) ((Time)(t) * TC0_PRESCALER / (F_CPU / 1000000ul))
+
+//! Largest number of ms TIME_MS_TO_RAW converts without overflow (~3.9 h)
+#define TIME_MS_TO_RAW_MAX  ((UINT32_MAX - 999ul) / TIME_RAW_PER_S)
+
 //----------------------------------------------------------------------------
 // Assembler macros
 //----------------------------------------------------------------------------
@@ -113,6 +163,50 @@ bool assertPstr(bool exp, char const* errormsg);
   );
 
 
+/*!
+ * \brief Saves the register context of a process that gives up the CPU voluntarily
+ *
+ * Builds a frame with the same layout as saveContext, so restoreContext can
+ * resume the process. As this is only used inside a function that is called
+ * by the process, the avr-gcc ABI allows us to skip the call-clobbered
+ * registers (r0, r18-r27, r30, r31). Their slots are reserved but not written.
+ * r1 is always zero in compiled code and has to be saved as such.
+ * Interrupts have to be disabled already.
+ */
+#define saveCalleeSavedContext() \
+  __asm__ volatile( \
+    "push  r31                           \n\t" \
+    "in    r31, __SREG__                 \n\t" \
+    "push  r31                           \n\t" \
+    "push  r30                           \n\t" \
+    "push  r29                           \n\t" \
+    "push  r28                           \n\t" \
+    "in    r26, __SP_L__                 \n\t" \
+    "in    r27, __SP_H__                 \n\t" \
+    "sbiw  r26, 10                       \n\t" \
+    "out   __SP_H__, r27                 \n\t" \
+    "out   __SP_L__, r26                 \n\t" \
+    "push  r17                           \n\t" \
+    "push  r16                           \n\t" \
+    "push  r15                           \n\t" \
+    "push  r14                           \n\t" \
+    "push  r13                           \n\t" \
+    "push  r12                           \n\t" \
+    "push  r11                           \n\t" \
+    "push  r10                           \n\t" \
+    "push  r9                            \n\t" \
+    "push  r8                            \n\t" \
+    "push  r7                            \n\t" \
+    "push  r6                            \n\t" \
+    "push  r5                            \n\t" \
+    "push  r4                            \n\t" \
+    "push  r3                            \n\t" \
+    "push  r2                            \n\t" \
+    "push  r1                            \n\t" \
+    "push  r0                            \n\t" \
+  );
+
+
 /*!
  * \brief Restores the register context on the stack
  *
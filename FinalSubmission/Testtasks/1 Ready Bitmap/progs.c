@@ -0,0 +1,211 @@
+//-------------------------------------------------
+//          TestSuite: Ready Bitmap
+//-------------------------------------------------
+// Compares the cycles needed to pick the next process with the
+// ready bitmap against the former linear scans of os_processes[].
+// Copy this file over SPOS/progs.c to run it.
+
+#include <avr/interrupt.h>
+#include <stdlib.h>
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+#include "os_scheduling_strategies.h"
+#include "os_input.h"
+
+// Number of scheduler calls that are averaged per measurement
+#define RUNS 32
+#define DELAY 2000
+
+// Former implementations working on the process array only
+static Age legacyAge[MAX_NUMBER_OF_PROCESSES];
+
+static ProcessID legacy_Even(Process const processes[], ProcessID current) {
+    uint8_t nextProc = (current + 1) % MAX_NUMBER_OF_PROCESSES;
+    while (nextProc != current) {
+        if (processes[nextProc].state == OS_PS_READY && nextProc != 0) {
+            return nextProc;
+        }
+        nextProc = (nextProc + 1) % MAX_NUMBER_OF_PROCESSES;
+    }
+    if (processes[nextProc].state == OS_PS_READY) {
+        return nextProc;
+    }
+    return 0;
+}
+
+static ProcessID legacy_Random(Process const processes[], ProcessID current) {
+    uint8_t active[MAX_NUMBER_OF_PROCESSES];
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < MAX_NUMBER_OF_PROCESSES; i++) {
+        if (processes[i].state == OS_PS_READY && processes[i].progID != 0) {
+            active[count++] = i;
+        }
+    }
+    if (count == 0) {
+        return 0;
+    }
+    return active[rand() % count];
+}
+
+static ProcessID legacy_InactiveAging(Process const processes[], ProcessID current) {
+    for (uint8_t i = 1; i < MAX_NUMBER_OF_PROCESSES; i++) {
+        if (i != current && processes[i].state == OS_PS_READY) {
+            legacyAge[i] += processes[i].priority;
+        }
+    }
+    uint8_t oldest = 1;
+    for (uint8_t i = 2; i < MAX_NUMBER_OF_PROCESSES; i++) {
+        if (processes[i].state != OS_PS_READY) {
+            continue;
+        }
+        if (legacyAge[i] > legacyAge[oldest]) {
+            oldest = i;
+        }
+        if (legacyAge[i] == legacyAge[oldest]) {
+            if (processes[i].priority == processes[oldest].priority) {
+                oldest = i < oldest ? i : oldest;
+            } else {
+                oldest = processes[i].priority > processes[oldest].priority ? i : oldest;
+            }
+        }
+    }
+    if (processes[oldest].state != OS_PS_READY) {
+        return 0;
+    }
+    legacyAge[oldest] = processes[oldest].priority;
+    return oldest;
+}
+
+static void legacy_unblock(Process processes[]) {
+    for (uint8_t i = 0; i < MAX_NUMBER_OF_PROCESSES; ++i) {
+        if (processes[i].state == OS_PS_BLOCKED) {
+            processes[i].state = OS_PS_READY;
+        }
+    }
+}
+
+extern ProcessMask os_blockedMask;
+
+static void bitmap_unblock(Process processes[]) {
+    ProcessMask blocked = os_blockedMask;
+    while (blocked) {
+        processes[os_firstProcessInMask(blocked)].state = OS_PS_READY;
+        blocked &= blocked - 1;
+    }
+}
+
+typedef ProcessID Strategy(Process const processes[], ProcessID current);
+
+//! Starts Timer 1 without prescaler, so TCNT1 counts CPU cycles
+static void startCycleCounter(void) {
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);
+}
+
+//! Average number of cycles one call of strategy takes (measurement overhead removed)
+static uint16_t measure(Strategy* strategy) {
+    Process const* processes = os_getProcessSlot(0);
+    ProcessID current = os_getCurrentProc();
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t start = TCNT1;
+    uint16_t empty = TCNT1 - start;
+    start = TCNT1;
+    for (uint8_t i = 0; i < RUNS; i++) {
+        current = strategy(processes, current);
+    }
+    uint16_t cycles = TCNT1 - start;
+    SREG = sreg;
+    return (cycles - empty) / RUNS;
+}
+
+static uint16_t measureUnblock(void (*unblock)(Process[])) {
+    Process* processes = os_getProcessSlot(0);
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t start = TCNT1;
+    uint16_t empty = TCNT1 - start;
+    start = TCNT1;
+    for (uint8_t i = 0; i < RUNS; i++) {
+        unblock(processes);
+    }
+    uint16_t cycles = TCNT1 - start;
+    SREG = sreg;
+    return (cycles - empty) / RUNS;
+}
+
+static void printLine(char const* name, uint16_t legacy, uint16_t bitmap) {
+    lcd_writeProgString(name);
+    lcd_writeDec(legacy);
+    lcd_writeChar('/');
+    lcd_writeDec(bitmap);
+    lcd_writeProgString(PSTR("   "));
+}
+
+//! Checks that the bitmap even strategy picks the same process as the scan
+static void checkEven(void) {
+    Process const* processes = os_getProcessSlot(0);
+    for (ProcessID current = 0; current < MAX_NUMBER_OF_PROCESSES; current++) {
+        if (legacy_Even(processes, current) != os_Scheduler_Even(processes, current)) {
+            os_error("Even mismatch");
+        }
+    }
+}
+
+PROGRAM(1, AUTOSTART) {
+    startCycleCounter();
+    lcd_writeProgString(PSTR("Ready bitmap    "));
+    lcd_writeProgString(PSTR("old/new cycles"));
+    delayMs(DELAY);
+
+    // Measure with a growing number of ready processes
+    for (uint8_t ready = os_getNumberOfActiveProcs(); ready <= MAX_NUMBER_OF_PROCESSES; ready++) {
+        os_enterCriticalSection();
+        // The scheduler sees the interrupted process as READY
+        os_setProcessState(os_getCurrentProc(), OS_PS_READY);
+        checkEven();
+        uint16_t evenOld = measure(legacy_Even);
+        uint16_t evenNew = measure(os_Scheduler_Even);
+        uint16_t randOld = measure(legacy_Random);
+        uint16_t randNew = measure(os_Scheduler_Random);
+        uint16_t agingOld = measure(legacy_InactiveAging);
+        uint16_t agingNew = measure(os_Scheduler_InactiveAging);
+        uint16_t unblockOld = measureUnblock(legacy_unblock);
+        uint16_t unblockNew = measureUnblock(bitmap_unblock);
+        os_setProcessState(os_getCurrentProc(), OS_PS_RUNNING);
+        os_leaveCriticalSection();
+
+        lcd_clear();
+        lcd_writeDec(ready);
+        lcd_writeProgString(PSTR(" procs"));
+        lcd_line2();
+        printLine(PSTR("unblk "), unblockOld, unblockNew);
+        delayMs(DELAY);
+
+        lcd_clear();
+        printLine(PSTR("even "), evenOld, evenNew);
+        lcd_line2();
+        printLine(PSTR("rand "), randOld, randNew);
+        delayMs(DELAY);
+
+        lcd_clear();
+        printLine(PSTR("aging "), agingOld, agingNew);
+        delayMs(DELAY);
+
+        if (ready < MAX_NUMBER_OF_PROCESSES && os_exec(2, DEFAULT_PRIORITY) == INVALID_PROCESS) {
+            os_error("Could not exec process");
+        }
+    }
+
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    while (1) {}
+}
+
+//! Dummy process to fill up the ready set
+PROGRAM(2, DONTSTART) {
+    while (1) {}
+}
@@ -0,0 +1,141 @@
+//-------------------------------------------------
+//          TestSuite: MLFQ Boost
+// Interactive processes that always yield keep the
+// highest MLFQ level and starve a CPU hog in the
+// lowest one. The test measures how many scheduling
+// steps the hog waits, without and with the boost.
+// Copy this file over SPOS/progs.c to run it.
+//-------------------------------------------------
+
+#include "os_core.h"
+#include "lcd.h"
+#include "util.h"
+#include "os_scheduler.h"
+#include "os_scheduling_strategies.h"
+#include "os_sync.h"
+#include "os_input.h"
+#include <avr/interrupt.h>
+#include <util/delay.h>
+
+//--------------CONFIG AREA------------------
+
+//! Number of scheduling steps every round lasts
+#define STEPS 120
+
+//! Boost interval of the second round
+#define BOOST 16
+
+//! Scheduling steps the hog may wait after a boost (the other processes at the top level)
+#define BOOST_SLACK 4
+
+//-------------------------------------------------
+
+ISR(TIMER2_COMPA_vect);
+
+//! Number of scheduling steps in the current round
+volatile uint16_t step;
+
+//! Step the hog got the CPU for the first time plus one (0 if it starved)
+volatile uint16_t hogStep;
+
+//! Set when the round is over
+volatile bool done;
+
+//! Runs one round with the passed boost interval and returns the step the hog got the CPU.
+uint16_t runRound(uint16_t interval) {
+    os_setMlfqBoostInterval(interval);
+    step = 0;
+    hogStep = 0;
+    done = false;
+
+    // two interactive processes in the highest and the hog in the lowest level
+    os_exec(2, 0b11000000);
+    os_exec(2, 0b11000000);
+    os_exec(3, 0b00000000);
+
+    while (!done) {
+        os_yield();
+    }
+    // wait for the others to terminate (the hog may only run now)
+    while (os_getNumberOfActiveProcs() > 2) {
+        os_yield();
+    }
+    return hogStep;
+}
+
+void printRound(uint16_t interval, uint16_t result) {
+    lcd_clear();
+    lcd_writeProgString(PSTR("Boost "));
+    lcd_writeDec(interval);
+    lcd_line2();
+    if (result) {
+        lcd_writeProgString(PSTR("hog ran at "));
+        lcd_writeDec(result);
+    } else {
+        lcd_writeProgString(PSTR("hog starved"));
+    }
+    _delay_ms(2000);
+}
+
+PROGRAM(1, AUTOSTART) {
+    // Disable scheduler-timer, the processes switch by yielding and stepping the scheduler
+    cbi(TCCR2B, CS22);
+    cbi(TCCR2B, CS21);
+    cbi(TCCR2B, CS20);
+
+    // start in the highest level like the interactive processes
+    os_setBasePriority(os_getCurrentProc(), 0b11000000);
+    os_setSchedulingStrategy(OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE);
+
+    lcd_writeProgString(PSTR("Testing MLFQ"));
+    lcd_line2();
+    lcd_writeProgString(PSTR("boost"));
+    _delay_ms(2000);
+
+    uint16_t const withoutBoost = runRound(0);
+    printRound(0, withoutBoost);
+
+    uint16_t const withBoost = runRound(BOOST);
+    printRound(BOOST, withBoost);
+
+    // without the boost the interactive processes keep the hog from running
+    if (withoutBoost) {
+        os_error("Hog not starved");
+    }
+    if (!withBoost || withBoost > BOOST + BOOST_SLACK) {
+        os_error("Hog not boosted");
+    }
+
+    // SUCCESS
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    lcd_line2();
+    lcd_writeProgString(PSTR(" PLEASE CONFIRM!"));
+    os_waitForInput();
+    os_waitForNoInput();
+    lcd_clear();
+    lcd_writeProgString(PSTR("WAITING FOR"));
+    lcd_line2();
+    lcd_writeProgString(PSTR("TERMINATION"));
+    delayMs(1000);
+}
+
+//! Interactive process: gives the CPU away right after each step
+PROGRAM(2, DONTSTART) {
+    while (!done) {
+        if (++step >= STEPS) {
+            done = true;
+        }
+        os_yield();
+    }
+}
+
+//! CPU hog: uses up every slice until the round is over
+PROGRAM(3, DONTSTART) {
+    if (!done) {
+        hogStep = step + 1;
+    }
+    while (!done) {
+        TIMER2_COMPA_vect();
+    }
+}
@@ -0,0 +1,110 @@
+//-------------------------------------------------
+//          TestSuite: CPU Accounting
+// A busy process and one that sleeps most of the
+// time run for a while. Their CPU load, dispatches
+// and scheduling latency are checked and shown.
+// Copy this file over SPOS/progs.c to run it.
+//-------------------------------------------------
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+#include "os_input.h"
+#include <avr/interrupt.h>
+
+//--------------CONFIG AREA------------------
+
+// How long the statistics are collected (in ms)
+#define MEASURE_MS (2000ul)
+
+// Sleep time of the interactive process per round (in ms)
+#define NAP_MS (50ul)
+
+// Minimum load of the busy and maximum load of the sleeping process (in percent)
+#define BUSY_MIN_LOAD (60)
+#define NAP_MAX_LOAD (10)
+
+// Maximum accepted scheduling latency of both processes (in us)
+#define MAX_LATENCY_US (20000ul)
+
+//------------END OF CONFIG------------------
+
+#define DELAY (2000ul)
+
+//! Shows the statistics of one process for a while
+void showStats(ProcessID pid, uint8_t load) {
+    ProcessStats const* stats = os_getProcessStats(pid);
+    lcd_clear();
+    lcd_writeChar('#');
+    lcd_writeDec(pid);
+    lcd_writeChar(' ');
+    lcd_writeDec(load);
+    lcd_writeProgString(PSTR("% D"));
+    lcd_writeDec(stats->dispatches);
+    lcd_line2();
+    lcd_writeProgString(PSTR("max lat "));
+    lcd_writeDec(TIME_TICKS_TO_US(stats->maxLatency));
+    lcd_writeProgString(PSTR("us"));
+    delayMs(DELAY);
+}
+
+PROGRAM(1, AUTOSTART) {
+    lcd_writeProgString(PSTR("CPU accounting"));
+
+    os_setSchedulingStrategy(OS_SS_ROUND_ROBIN);
+    ProcessID const busy = os_exec(2, DEFAULT_PRIORITY);
+    ProcessID const nap = os_exec(3, DEFAULT_PRIORITY);
+    os_resetProcessStats();
+
+    // this process sleeps as well, so the two others share the CPU
+    os_sleepMs(MEASURE_MS);
+
+    // freeze the numbers before they are checked
+    uint8_t const busyLoad = os_getCpuLoad(busy);
+    uint8_t const napLoad = os_getCpuLoad(nap);
+    uint16_t const napDispatches = os_getProcessStats(nap)->dispatches;
+    Time const busyLatency = TIME_TICKS_TO_US(os_getProcessStats(busy)->maxLatency);
+    Time const napLatency = TIME_TICKS_TO_US(os_getProcessStats(nap)->maxLatency);
+    os_kill(busy);
+    os_kill(nap);
+
+    showStats(busy, busyLoad);
+    showStats(nap, napLoad);
+
+    if (busyLoad < BUSY_MIN_LOAD) {
+        os_error("Busy load too low");
+    }
+    if (napLoad > NAP_MAX_LOAD) {
+        os_error("Nap load too high");
+    }
+    // the sleeping process wakes up once per nap
+    if (napDispatches < MEASURE_MS / NAP_MS / 2) {
+        os_error("Too few dispatches");
+    }
+    // a few time slices at most, a saturated maximum means a broken stamp
+    if (busyLatency > MAX_LATENCY_US || napLatency > MAX_LATENCY_US) {
+        os_error("Latency too high");
+    }
+
+    // SUCCESS
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    lcd_line2();
+    lcd_writeProgString(PSTR(" PLEASE CONFIRM!"));
+    os_waitForInput();
+    os_waitForNoInput();
+}
+
+//! Busy process
+PROGRAM(2, DONTSTART) {
+    while (1) {
+    }
+}
+
+//! Interactive process that sleeps most of the time
+PROGRAM(3, DONTSTART) {
+    while (1) {
+        os_sleepMs(NAP_MS);
+    }
+}
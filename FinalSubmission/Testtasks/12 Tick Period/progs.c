@@ -0,0 +1,102 @@
+//-------------------------------------------------
+//          TestSuite: Tick Period
+// Two busy processes share the CPU with different
+// tick periods and quanta. The number of scheduling
+// decisions is compared to the expected rate.
+// Copy this file over SPOS/progs.c to run it.
+//-------------------------------------------------
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+#include "os_input.h"
+#include <avr/interrupt.h>
+
+//--------------CONFIG AREA------------------
+
+// How long every configuration is measured (in ms)
+#define MEASURE_MS (1000ul)
+
+// Allowed deviation from the expected number of decisions (in percent)
+#define TOLERANCE (20)
+
+//------------END OF CONFIG------------------
+
+#define DELAY (2000ul)
+
+//! A tick period (in us) and a quantum (in ticks) to measure
+typedef struct {
+    uint16_t tick;
+    uint8_t quantum;
+} Config;
+
+Config const configs[] = {
+    { 1000, 1 },
+    { 1000, 4 },
+    { 5000, 1 },
+    { 500, 2 },
+};
+
+#define CONFIGCOUNT (sizeof(configs) / sizeof(configs[0]))
+
+//! Runs both workers with the passed configuration and returns the number of dispatches
+uint16_t measure(Config const* config, ProcessID a, ProcessID b) {
+    os_setTickPeriod(config->tick);
+    os_setStrategyQuantum(OS_SS_EVEN, config->quantum);
+    os_resetProcessStats();
+    os_sleepMs(MEASURE_MS);
+
+    os_enterCriticalSection();
+    uint16_t const dispatches = os_getProcessStats(a)->dispatches + os_getProcessStats(b)->dispatches;
+    os_leaveCriticalSection();
+    return dispatches;
+}
+
+PROGRAM(1, AUTOSTART) {
+    lcd_writeProgString(PSTR("Tick period"));
+    delayMs(DELAY);
+
+    os_setSchedulingStrategy(OS_SS_EVEN);
+    ProcessID const a = os_exec(2, DEFAULT_PRIORITY);
+    ProcessID const b = os_exec(2, DEFAULT_PRIORITY);
+
+    for (uint8_t i = 0; i < CONFIGCOUNT; i++) {
+        Config const* config = &configs[i];
+        uint16_t const expected = (MEASURE_MS * 1000ul) / config->tick / config->quantum;
+        uint16_t const dispatches = measure(config, a, b);
+
+        lcd_clear();
+        lcd_writeDec(config->tick);
+        lcd_writeProgString(PSTR("us Q"));
+        lcd_writeDec(config->quantum);
+        lcd_line2();
+        lcd_writeDec(dispatches);
+        lcd_writeProgString(PSTR(" of ~"));
+        lcd_writeDec(expected);
+        delayMs(DELAY);
+
+        if (dispatches * 100ul < expected * (100ul - TOLERANCE) || dispatches * 100ul > expected * (100ul + TOLERANCE)) {
+            os_error("Wrong tick rate");
+        }
+    }
+
+    os_kill(a);
+    os_kill(b);
+    os_setTickPeriod(SCHEDULER_TICK_US);
+    os_setStrategyQuantum(OS_SS_EVEN, SCHEDULER_QUANTUM);
+
+    // SUCCESS
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    lcd_line2();
+    lcd_writeProgString(PSTR(" PLEASE CONFIRM!"));
+    os_waitForInput();
+    os_waitForNoInput();
+}
+
+//! Busy worker
+PROGRAM(2, DONTSTART) {
+    while (1) {
+    }
+}
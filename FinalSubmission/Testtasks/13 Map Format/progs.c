@@ -0,0 +1,149 @@
+//-------------------------------------------------
+//          TestSuite: Map Format
+// Every free process slot is filled with a process
+// that allocates a chunk on every heap. The owner,
+// continuation and shared entries of the maps are
+// checked for the configured map formats (nibble
+// on the internal, byte on the external heap, see
+// INT_HEAP_MAP_FORMAT and EXT_HEAP_MAP_FORMAT).
+// Copy this file over SPOS/progs.c to run it.
+//-------------------------------------------------
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+#include "os_memory.h"
+#include "os_memheap_drivers.h"
+#include "os_input.h"
+#include <avr/interrupt.h>
+
+//--------------CONFIG AREA------------------
+
+// Size of the chunk every worker allocates (in bytes)
+#define CHUNK (4)
+
+//------------END OF CONFIG------------------
+
+#define DELAY (2000ul)
+
+//! Number of heaps that are checked
+#define HEAPS (2)
+
+//! Chunk of every worker on every heap (0 until it is allocated)
+volatile MemAddr chunks[HEAPS][MAX_NUMBER_OF_PROCESSES];
+
+//! Set when the workers may terminate
+volatile bool done;
+
+//! Checks the owner and continuation entries of the passed chunk
+void checkChunk(Heap* heap, MemAddr addr, MemValue owner) {
+    if (os_getMapEntry(heap, addr) != owner) {
+        os_error("Wrong owner");
+    }
+    for (uint8_t i = 1; i < CHUNK; i++) {
+        if (os_getMapEntry(heap, addr + i) != os_getMapContinuationValue(heap)) {
+            os_error("Wrong continuation");
+        }
+    }
+}
+
+//! Checks the shared entries of the map of the passed heap
+void checkShared(Heap* heap) {
+    MemAddr shared = os_sh_malloc(heap, CHUNK);
+    checkChunk(heap, shared, os_getMapSharedValue(heap));
+    os_sh_readOpen(heap, &shared);
+    os_sh_readOpen(heap, &shared);
+    checkChunk(heap, shared, os_getMapSharedValue(heap) + 2);
+    os_sh_close(heap, shared);
+    os_sh_close(heap, shared);
+    os_sh_writeOpen(heap, &shared);
+    checkChunk(heap, shared, os_getMapContinuationValue(heap) - 1);
+    os_sh_close(heap, shared);
+    checkChunk(heap, shared, os_getMapSharedValue(heap));
+    os_sh_free(heap, &shared);
+}
+
+PROGRAM(1, AUTOSTART) {
+    for (uint8_t h = 0; h < HEAPS; h++) {
+        Heap* const heap = os_lookupHeap(h);
+        lcd_clear();
+        lcd_writeProgString(heap->mapFormat == OS_MAP_BYTE ? PSTR("Byte map ") : PSTR("Nibble map "));
+        lcd_writeDec(os_getMapOverhead(heap));
+        lcd_writeChar('%');
+        lcd_line2();
+        lcd_writeDec(MAX_NUMBER_OF_PROCESSES);
+        lcd_writeProgString(PSTR(" processes"));
+        delayMs(DELAY);
+    }
+    if (intHeap->mapFormat == extHeap->mapFormat) {
+        os_error("Formats not mixed");
+    }
+
+    // fill the process table
+    uint8_t workers = 0;
+    while (os_exec(2, DEFAULT_PRIORITY) != INVALID_PROCESS) {
+        workers++;
+    }
+    if (workers != MAX_NUMBER_OF_PROCESSES - 2) {
+        os_error("Table not filled");
+    }
+
+    // wait for every worker to allocate its chunk
+    for (ProcessID pid = 2; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        while (!chunks[HEAPS - 1][pid]) {
+            os_yield();
+        }
+    }
+
+    lcd_clear();
+    lcd_writeProgString(PSTR("Owners"));
+    for (uint8_t h = 0; h < HEAPS; h++) {
+        for (ProcessID pid = 2; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+            checkChunk(os_lookupHeap(h), chunks[h][pid], pid);
+        }
+    }
+    delayMs(DELAY);
+
+    // the chunks are freed when the workers terminate
+    done = true;
+    while (os_getNumberOfActiveProcs() > 2) {
+        os_yield();
+    }
+    for (uint8_t h = 0; h < HEAPS; h++) {
+        for (ProcessID pid = 2; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+            if (os_getMapEntry(os_lookupHeap(h), chunks[h][pid])) {
+                os_error("Chunk not freed");
+            }
+        }
+    }
+
+    lcd_clear();
+    lcd_writeProgString(PSTR("Shared"));
+    for (uint8_t h = 0; h < HEAPS; h++) {
+        checkShared(os_lookupHeap(h));
+    }
+    delayMs(DELAY);
+
+    // SUCCESS
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    lcd_line2();
+    lcd_writeProgString(PSTR(" PLEASE CONFIRM!"));
+    os_waitForInput();
+    os_waitForNoInput();
+}
+
+//! Worker that owns a chunk until the test is done
+PROGRAM(2, DONTSTART) {
+    for (uint8_t h = 0; h < HEAPS; h++) {
+        MemAddr const chunk = os_malloc(os_lookupHeap(h), CHUNK);
+        if (!chunk) {
+            os_error("Out of memory");
+        }
+        chunks[h][os_getCurrentProc()] = chunk;
+    }
+    while (!done) {
+        os_yield();
+    }
+}
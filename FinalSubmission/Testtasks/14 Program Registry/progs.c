@@ -0,0 +1,92 @@
+//-------------------------------------------------
+//          TestSuite: Program Registry
+// Looks up the programs of this file in the flash
+// program table in both directions and checks the
+// autostart flag, priority and stack size given to
+// the PROGRAM macro.
+// Copy this file over SPOS/progs.c to run it.
+//-------------------------------------------------
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+#include "os_input.h"
+#include <avr/interrupt.h>
+
+#define DELAY (2000ul)
+
+//! Priority of the autostarted program 1
+#define PRIO (0xC3)
+
+//! Stack size of program 3
+#define STACK (96)
+
+Program prog2;
+Program prog3;
+
+//! Not a program, must not be found in the table
+void notAProgram(void) {
+}
+
+PROGRAM_EX(1, AUTOSTART, 0, PRIO) {
+    lcd_writeProgString(PSTR("Program registry"));
+    delayMs(DELAY);
+
+    // idle program + the three programs of this file
+    if (os_getNumberOfRegisteredPrograms() != 4) {
+        os_error("Wrong count");
+    }
+
+    // function -> id
+    if (os_lookupProgramID(prog2) != 2 || os_lookupProgramID(prog3) != 3) {
+        os_error("Wrong id");
+    }
+    if (os_lookupProgramID(notAProgram) != INVALID_PROGRAM || os_lookupProgramID(NULL) != INVALID_PROGRAM) {
+        os_error("Found non-program");
+    }
+
+    // id -> function
+    if (os_lookupProgramFunction(2) != prog2 || os_lookupProgramFunction(3) != prog3) {
+        os_error("Wrong function");
+    }
+    if (os_lookupProgramFunction(4) || os_lookupProgramFunction(MAX_NUMBER_OF_PROGRAMS)) {
+        os_error("Found missing prog");
+    }
+
+    // metadata
+    if (!os_checkAutostartProgram(1) || os_checkAutostartProgram(2)) {
+        os_error("Wrong autostart");
+    }
+    if (os_getProcessSlot(os_getCurrentProc())->priority != PRIO || os_getProgramPriority(2) != DEFAULT_PRIORITY) {
+        os_error("Wrong priority");
+    }
+    if (os_getProgramStackSize(3) != STACK || os_getProgramStackSize(2) != STACK_SIZE_PROC) {
+        os_error("Wrong stack size");
+    }
+
+    // a program started by its id runs the right function
+    ProcessID const pid = os_exec(os_lookupProgramID(prog3), DEFAULT_PRIORITY);
+    while (os_getProcessSlot(pid)->state != OS_PS_UNUSED) {
+        os_yield();
+    }
+
+    // SUCCESS
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    lcd_line2();
+    lcd_writeProgString(PSTR(" PLEASE CONFIRM!"));
+    os_waitForInput();
+    os_waitForNoInput();
+}
+
+PROGRAM(2, DONTSTART) {
+    os_error("Prog 2 started");
+}
+
+//! Checks that it got the stack it asked for
+PROGRAM_EX(3, DONTSTART, STACK, DEFAULT_PRIORITY) {
+    if (os_getProcessSlot(os_getCurrentProc())->stackSize != STACK) {
+        os_error("Wrong stack");
+    }
+}
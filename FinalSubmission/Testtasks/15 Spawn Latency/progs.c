@@ -0,0 +1,99 @@
+//-------------------------------------------------
+//          TestSuite: Spawn Latency
+// Spawns a short-lived worker over and over and
+// measures how long os_exec takes and how long it
+// takes until the worker runs for the first time.
+// Copy this file over SPOS/progs.c to run it.
+//-------------------------------------------------
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+#include "os_input.h"
+#include <avr/interrupt.h>
+
+//--------------CONFIG AREA------------------
+
+// Number of spawned workers
+#define SPAWNS (200)
+
+// Maximum average time from os_exec to the first instruction of the worker (in us)
+#define MAX_AVERAGE_US (400)
+
+//------------END OF CONFIG------------------
+
+#define DELAY (2000ul)
+
+//! Time (Timer 0 ticks) the latest worker started running
+volatile Time started;
+
+//! Shows the average and maximum of a measurement
+void showResult(char const* name, Time sum, Time max) {
+    lcd_clear();
+    lcd_writeProgString(name);
+    lcd_line2();
+    lcd_writeProgString(PSTR("avg "));
+    lcd_writeDec(TIME_TICKS_TO_US(sum) / SPAWNS);
+    lcd_writeProgString(PSTR(" max "));
+    lcd_writeDec(TIME_TICKS_TO_US(max));
+    delayMs(DELAY);
+}
+
+PROGRAM(1, AUTOSTART) {
+    lcd_writeProgString(PSTR("Spawn latency"));
+    delayMs(DELAY);
+
+    os_setSchedulingStrategy(OS_SS_EVEN);
+    Time execSum = 0, execMax = 0;
+    Time runSum = 0, runMax = 0;
+
+    for (uint16_t i = 0; i < SPAWNS; i++) {
+        started = 0;
+        Time const before = os_systemTime_augment();
+        ProcessID const pid = os_exec(2, DEFAULT_PRIORITY);
+        Time const exec = os_systemTime_augment() - before;
+        if (pid == INVALID_PROCESS) {
+            os_error("Spawn failed");
+        }
+
+        // the worker is the only other process, so it runs next
+        os_yield();
+        while (os_getProcessSlot(pid)->state != OS_PS_UNUSED) {
+            os_yield();
+        }
+        if (!started) {
+            os_error("Worker did not run");
+        }
+
+        Time const run = started - before;
+        execSum += exec;
+        runSum += run;
+        if (exec > execMax) {
+            execMax = exec;
+        }
+        if (run > runMax) {
+            runMax = run;
+        }
+    }
+
+    showResult(PSTR("os_exec (us)"), execSum, execMax);
+    showResult(PSTR("to first run (us)"), runSum, runMax);
+
+    if (TIME_TICKS_TO_US(runSum) / SPAWNS > MAX_AVERAGE_US) {
+        os_error("Spawn too slow");
+    }
+
+    // SUCCESS
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    lcd_line2();
+    lcd_writeProgString(PSTR(" PLEASE CONFIRM!"));
+    os_waitForInput();
+    os_waitForNoInput();
+}
+
+//! Short-lived worker that only records when it started
+PROGRAM(2, DONTSTART) {
+    started = os_systemTime_augment();
+}
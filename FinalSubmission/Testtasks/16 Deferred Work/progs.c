@@ -0,0 +1,158 @@
+//-------------------------------------------------
+//          TestSuite: Deferred Work
+// Fills the deferred work queue from a process and
+// checks the overflow, the budget per scheduling
+// decision and the order. Then a Timer 1 interrupt
+// posts work for a while, which has to run outside
+// of the interrupt with interrupts enabled.
+// Copy this file over SPOS/progs.c to run it.
+//-------------------------------------------------
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+#include "os_deferred.h"
+#include "os_input.h"
+#include <avr/interrupt.h>
+
+//--------------CONFIG AREA------------------
+
+// How long the timer interrupt posts work (in ms)
+#define MEASURE_MS (1000ul)
+
+// Compare value of Timer 1 (prescaler 64): 1 kHz
+#define TIMER1_COMPARE (312)
+
+//------------END OF CONFIG------------------
+
+#define DELAY (2000ul)
+
+//! Number of procedures that ran
+volatile uint16_t ran;
+
+//! Argument the next procedure of the first test expects
+volatile uint8_t expected;
+
+//! Number of procedures that were posted by the timer interrupt
+volatile uint16_t posted;
+
+//! Set if a procedure ran inside an interrupt (interrupts disabled)
+volatile bool inInterrupt;
+
+//! Scheduling decision the latest procedure ran after
+uint16_t lastDecision;
+
+//! Number of procedures that ran after the latest and after any single decision
+uint8_t batch, maxBatch;
+
+//! Returns the number of scheduling decisions so far
+uint16_t decisions(void) {
+    uint16_t sum = 0;
+    for (ProcessID pid = 0; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        sum += os_getProcessStats(pid)->dispatches;
+    }
+    return sum;
+}
+
+//! Checks that the procedures run in the order they were posted
+void ordered(void* arg) {
+    if ((uint8_t)(uint16_t)arg != expected) {
+        os_error("Wrong order");
+    }
+    uint16_t const decision = decisions();
+    batch = decision == lastDecision ? batch + 1 : 1;
+    lastDecision = decision;
+    if (batch > maxBatch) {
+        maxBatch = batch;
+    }
+    expected++;
+    ran++;
+}
+
+//! Counts the procedures posted by the timer interrupt
+void counted(void* arg) {
+    if (!(SREG & (1 << 7))) {
+        inInterrupt = true;
+    }
+    ran++;
+}
+
+ISR(TIMER1_COMPA_vect) {
+    if (os_deferPostFromIsr(counted, NULL)) {
+        posted++;
+    }
+}
+
+void showResult(uint16_t dropped) {
+    lcd_clear();
+    lcd_writeProgString(PSTR("posted "));
+    lcd_writeDec(posted);
+    lcd_line2();
+    lcd_writeProgString(PSTR("ran "));
+    lcd_writeDec(ran);
+    lcd_writeProgString(PSTR(" lost "));
+    lcd_writeDec(dropped);
+    delayMs(DELAY);
+}
+
+PROGRAM(1, AUTOSTART) {
+    lcd_writeProgString(PSTR("Deferred work"));
+    delayMs(DELAY);
+
+    // Fill the queue without letting the scheduler drain it
+    os_enterCriticalSection();
+    uint16_t const droppedBefore = os_getDeferredDropped();
+    for (uint8_t i = 0; i < DEFERRED_QUEUE_SIZE; i++) {
+        if (!os_deferPost(ordered, (void*)(uint16_t)i)) {
+            os_error("Queue too small");
+        }
+    }
+    if (os_deferPost(ordered, NULL) || os_getDeferredDropped() != droppedBefore + 1) {
+        os_error("Overflow missed");
+    }
+    os_leaveCriticalSection();
+
+    // Every scheduling decision runs the budget only
+    lastDecision = decisions();
+    while (os_getDeferredPending()) {
+        os_yield();
+    }
+    if (ran != DEFERRED_QUEUE_SIZE) {
+        os_error("Work lost");
+    }
+    if (maxBatch != (DEFERRED_QUEUE_SIZE > DEFERRED_BUDGET ? DEFERRED_BUDGET : DEFERRED_QUEUE_SIZE)) {
+        os_error("Budget exceeded");
+    }
+
+    // Timer 1 in CTC mode posts one procedure per ms
+    ran = 0;
+    posted = 0;
+    uint16_t const dropped = os_getDeferredDropped();
+    OCR1A = TIMER1_COMPARE;
+    TCCR1A = 0;
+    TCCR1B = (1 << WGM12) | (1 << CS11) | (1 << CS10);
+    TIMSK1 |= (1 << OCIE1A);
+    delayMs(MEASURE_MS);
+    TIMSK1 &= ~(1 << OCIE1A);
+    TCCR1B = 0;
+    while (os_getDeferredPending()) {
+        os_yield();
+    }
+
+    showResult(os_getDeferredDropped() - dropped);
+    if (!posted || ran != posted) {
+        os_error("Work lost");
+    }
+    if (inInterrupt) {
+        os_error("Ran in interrupt");
+    }
+
+    // SUCCESS
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    lcd_line2();
+    lcd_writeProgString(PSTR(" PLEASE CONFIRM!"));
+    os_waitForInput();
+    os_waitForNoInput();
+}
@@ -0,0 +1,154 @@
+//-------------------------------------------------
+//          TestSuite: Interrupt Latency
+// Timer 1 raises an interrupt every ms and records
+// how late the handler starts. The worst case is
+// measured while a process writes to the LCD and
+// uses the external heap (SPI), once with every
+// call wrapped in disabled interrupts like the old
+// critical sections did, and once as they are now.
+// Copy this file over SPOS/progs.c to run it.
+//-------------------------------------------------
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+#include "os_memory.h"
+#include "os_memheap_drivers.h"
+#include "os_input.h"
+#include <avr/interrupt.h>
+
+//--------------CONFIG AREA------------------
+
+// How long every workload is measured (in ms)
+#define MEASURE_MS (2000ul)
+
+// Maximum accepted worst-case latency with the new primitives (in us)
+#define MAX_LATENCY_US (250)
+
+// Size of the chunks allocated on the external heap
+#define CHUNK (32)
+
+//------------END OF CONFIG------------------
+
+#define DELAY (2000ul)
+
+// Timer 1 runs without prescaler: 1 ms period
+#define TIMER1_COMPARE (F_CPU / 1000ul - 1)
+#define CYCLES_TO_US(c) ((c) / (F_CPU / 1000000ul))
+
+//! Worst latency (in CPU cycles) since the last reset
+volatile uint16_t maxLatency;
+
+//! Number of handled interrupts since the last reset
+volatile uint16_t samples;
+
+//! Set while the workload should keep running
+volatile bool busy;
+
+//! Whether the workload disables interrupts around every call
+volatile bool irqOff;
+
+ISR(TIMER1_COMPA_vect) {
+    // The counter restarted at the compare match
+    uint16_t const latency = TCNT1;
+    if (latency > maxLatency) {
+        maxLatency = latency;
+    }
+    samples++;
+}
+
+//! Runs the workload (or nothing) for a while and returns the worst latency in us
+uint16_t measure(bool workload, bool withIrqOff) {
+    irqOff = withIrqOff;
+    ProcessID worker = INVALID_PROCESS;
+    if (workload) {
+        busy = true;
+        worker = os_exec(2, DEFAULT_PRIORITY);
+    }
+
+    uint8_t const sreg = os_irqSave();
+    maxLatency = 0;
+    samples = 0;
+    os_irqRestore(sreg);
+    os_sleepMs(MEASURE_MS);
+
+    if (workload) {
+        busy = false;
+        while (os_getProcessSlot(worker)->state != OS_PS_UNUSED) {
+            os_yield();
+        }
+    }
+    if (samples < MEASURE_MS / 2) {
+        os_error("Timer 1 stalled");
+    }
+    return CYCLES_TO_US(maxLatency);
+}
+
+void showResult(char const* name, uint16_t us) {
+    lcd_clear();
+    lcd_writeProgString(name);
+    lcd_line2();
+    lcd_writeProgString(PSTR("max "));
+    lcd_writeDec(us);
+    lcd_writeProgString(PSTR("us"));
+    delayMs(DELAY);
+}
+
+PROGRAM(1, AUTOSTART) {
+    lcd_writeProgString(PSTR("IRQ latency"));
+    delayMs(DELAY);
+
+    // Timer 1 in CTC mode without prescaler
+    OCR1A = TIMER1_COMPARE;
+    TCCR1A = 0;
+    TCCR1B = (1 << WGM12) | (1 << CS10);
+    TIMSK1 |= (1 << OCIE1A);
+
+    uint16_t const idle = measure(false, false);
+    uint16_t const before = measure(true, true);
+    uint16_t const after = measure(true, false);
+
+    TIMSK1 &= ~(1 << OCIE1A);
+    TCCR1B = 0;
+
+    showResult(PSTR("No load"), idle);
+    showResult(PSTR("IRQs off (old)"), before);
+    showResult(PSTR("Preempt off (new)"), after);
+
+    if (after > before) {
+        os_error("No improvement");
+    }
+    if (after > MAX_LATENCY_US) {
+        os_error("Latency too high");
+    }
+
+    // SUCCESS
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    lcd_line2();
+    lcd_writeProgString(PSTR(" PLEASE CONFIRM!"));
+    os_waitForInput();
+    os_waitForNoInput();
+}
+
+//! Writes to the LCD and allocates on the external heap until it is stopped
+PROGRAM(2, DONTSTART) {
+    uint8_t i = 0;
+    while (busy) {
+        uint8_t sreg = 0;
+        if (irqOff) {
+            sreg = os_irqSave();
+        }
+        lcd_goto(2, 13);
+        lcd_writeDec(i++ % 10);
+        MemAddr const chunk = os_malloc(extHeap, CHUNK);
+        if (!chunk) {
+            os_error("Out of memory");
+        }
+        os_free(extHeap, chunk);
+        if (irqOff) {
+            os_irqRestore(sreg);
+        }
+    }
+}
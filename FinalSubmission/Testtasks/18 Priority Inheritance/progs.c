@@ -0,0 +1,162 @@
+//-------------------------------------------------
+//          TestSuite: Priority Inheritance
+// A process with a low priority holds a mutex and
+// then a shared memory chunk while a process with
+// a high priority waits for it. The holder has to
+// run with the high priority until it releases,
+// then with its own priority again. The waiter must
+// not use the CPU meanwhile.
+// Copy this file over SPOS/progs.c to run it.
+//-------------------------------------------------
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+#include "os_memory.h"
+#include "os_memheap_drivers.h"
+#include "os_sync.h"
+#include "os_input.h"
+
+//--------------CONFIG AREA------------------
+
+// Priority of the holder
+#define LOW (10)
+
+// Priority of the waiter
+#define HIGH (200)
+
+// Number of yields the holder may need to inherit the priority
+#define MAX_YIELDS (100)
+
+// Size of the shared chunk
+#define CHUNK (8)
+
+//------------END OF CONFIG------------------
+
+#define DELAY (2000ul)
+
+static Mutex lock = MUTEX_INIT;
+
+//! Shared chunk both processes open
+MemAddr shared;
+
+//! Set by the holder once it holds the mutex or the chunk
+volatile bool holding;
+
+//! Set by the main process when the holder should release
+volatile bool release;
+
+//! Set by the waiter once it got the mutex or the chunk
+volatile bool gotIt;
+
+//! Waits until flag is set, fails with the passed message after MAX_YIELDS yields
+void awaitFlag(volatile bool* flag, char const* error) {
+    for (uint16_t i = 0; !*flag; i++) {
+        if (i == MAX_YIELDS) {
+            os_error(error);
+        }
+        os_yield();
+    }
+}
+
+//! Waits until the effective priority of the holder is the passed one
+void awaitPriority(ProcessID holder, Priority priority, char const* error) {
+    for (uint16_t i = 0; os_getProcessSlot(holder)->priority != priority; i++) {
+        if (i == MAX_YIELDS) {
+            os_error(error);
+        }
+        os_yield();
+    }
+    if (os_getProcessSlot(holder)->basePriority != LOW) {
+        os_error("Base changed");
+    }
+}
+
+//! Runs one phase: program 2 holds, program 3 waits
+void phase(char const* name, uint8_t holderProgram, uint8_t waiterProgram) {
+    lcd_clear();
+    lcd_writeProgString(name);
+    holding = release = gotIt = false;
+
+    ProcessID const holder = os_exec(holderProgram, LOW);
+    awaitFlag(&holding, "Holder stuck");
+    ProcessID const waiter = os_exec(waiterProgram, HIGH);
+    if (holder == INVALID_PROCESS || waiter == INVALID_PROCESS) {
+        os_error("Spawn failed");
+    }
+
+    awaitPriority(holder, HIGH, "Not inherited");
+    if (os_getProcessSlot(waiter)->state != OS_PS_WAITING) {
+        os_error("Waiter spins");
+    }
+    lcd_line2();
+    lcd_writeProgString(PSTR("inherited "));
+    lcd_writeDec(os_getProcessSlot(holder)->priority);
+
+    release = true;
+    awaitFlag(&gotIt, "Waiter stuck");
+    awaitPriority(holder, LOW, "Not restored");
+    while (os_getProcessSlot(holder)->state != OS_PS_UNUSED
+           || os_getProcessSlot(waiter)->state != OS_PS_UNUSED) {
+        os_yield();
+    }
+    delayMs(DELAY);
+}
+
+PROGRAM(1, AUTOSTART) {
+    lcd_writeProgString(PSTR("Priority inherit"));
+    delayMs(DELAY);
+
+    os_setSchedulingStrategy(OS_SS_INACTIVE_AGING);
+    phase(PSTR("Mutex"), 2, 3);
+
+    shared = os_sh_malloc(intHeap, CHUNK);
+    if (!shared) {
+        os_error("Out of memory");
+    }
+    phase(PSTR("Shared chunk"), 4, 5);
+    os_sh_free(intHeap, &shared);
+
+    // SUCCESS
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    lcd_line2();
+    lcd_writeProgString(PSTR(" PLEASE CONFIRM!"));
+    os_waitForInput();
+    os_waitForNoInput();
+}
+
+//! Holds the mutex until it is told to release it
+PROGRAM(2, DONTSTART) {
+    os_mutexLock(&lock);
+    holding = true;
+    while (!release) {
+        os_yield();
+    }
+    os_mutexUnlock(&lock);
+}
+
+//! Waits for the mutex
+PROGRAM(3, DONTSTART) {
+    os_mutexLock(&lock);
+    gotIt = true;
+    os_mutexUnlock(&lock);
+}
+
+//! Holds the shared chunk open for writing until it is told to close it
+PROGRAM(4, DONTSTART) {
+    MemAddr const addr = os_sh_writeOpen(intHeap, &shared);
+    holding = true;
+    while (!release) {
+        os_yield();
+    }
+    os_sh_close(intHeap, addr);
+}
+
+//! Waits to read the shared chunk
+PROGRAM(5, DONTSTART) {
+    MemAddr const addr = os_sh_readOpen(intHeap, &shared);
+    gotIt = true;
+    os_sh_close(intHeap, addr);
+}
@@ -0,0 +1,94 @@
+//-------------------------------------------------
+//          TestSuite: CPU Budget
+// A process that never gives up the CPU runs under
+// run-to-completion with a CPU budget. It has to be
+// throttled once per window, so its CPU load stays
+// at the budget and the other processes still get
+// the CPU.
+// Copy this file over SPOS/progs.c to run it.
+//-------------------------------------------------
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+#include "os_input.h"
+
+//--------------CONFIG AREA------------------
+
+// Budget of the hog (in scheduler ticks per window)
+#define BUDGET_TICKS (2)
+#define BUDGET_WINDOW (10)
+
+// How long the load is measured (in ms)
+#define MEASURE_MS (2000ul)
+
+// Accepted deviation of the load from the budget (in percent)
+#define TOLERANCE (8)
+
+//------------END OF CONFIG------------------
+
+#define DELAY (2000ul)
+
+#define BUDGET_PERCENT (100 * BUDGET_TICKS / BUDGET_WINDOW)
+
+PROGRAM(1, AUTOSTART) {
+    lcd_writeProgString(PSTR("CPU budget"));
+    delayMs(DELAY);
+
+    if (os_setCpuBudget(0, BUDGET_TICKS, BUDGET_WINDOW) || os_setCpuBudget(1, BUDGET_WINDOW + 1, BUDGET_WINDOW)) {
+        os_error("Invalid accepted");
+    }
+
+    os_setSchedulingStrategy(OS_SS_RUN_TO_COMPLETION);
+    ProcessID const hog = os_exec(2, DEFAULT_PRIORITY);
+    if (hog == INVALID_PROCESS || !os_setCpuBudget(hog, BUDGET_TICKS, BUDGET_WINDOW)) {
+        os_error("Spawn failed");
+    }
+
+    // Without the budget the hog would never give the CPU back
+    os_resetProcessStats();
+    os_sleepMs(MEASURE_MS);
+    uint8_t const load = os_getCpuLoad(hog);
+    CpuBudget const* const budget = os_getCpuBudget(hog);
+
+    lcd_clear();
+    lcd_writeProgString(PSTR("Hog load "));
+    lcd_writeDec(load);
+    lcd_writeChar('%');
+    lcd_line2();
+    lcd_writeProgString(PSTR("throttled "));
+    lcd_writeDec(budget->throttles);
+    delayMs(DELAY);
+
+    if (!budget->throttles) {
+        os_error("Never throttled");
+    }
+    if (load > BUDGET_PERCENT + TOLERANCE || load + TOLERANCE < BUDGET_PERCENT) {
+        os_error("Budget not kept");
+    }
+
+    // A throttled process can be killed like any other
+    while (os_getProcessSlot(hog)->state != OS_PS_THROTTLED) {
+        os_yield();
+    }
+    os_kill(hog);
+    if (os_getProcessSlot(hog)->state != OS_PS_UNUSED) {
+        os_error("Kill failed");
+    }
+    os_setSchedulingStrategy(OS_SS_EVEN);
+
+    // SUCCESS
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    lcd_line2();
+    lcd_writeProgString(PSTR(" PLEASE CONFIRM!"));
+    os_waitForInput();
+    os_waitForNoInput();
+}
+
+//! Never gives up the CPU on its own
+PROGRAM(2, DONTSTART) {
+    while (1) {
+    }
+}
@@ -0,0 +1,103 @@
+//-------------------------------------------------
+//          TestSuite: Yield Fast Path
+//-------------------------------------------------
+// Two processes hand the CPU back and forth with os_yield.
+// Compares the cycles of one voluntary context switch with the
+// fast path against the former way of calling the timer interrupt.
+// Switching between both variants also checks that a process saved
+// by one of them can be restored by the other.
+// Copy this file over SPOS/progs.c to run it.
+
+#include <avr/interrupt.h>
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+
+// Number of round trips that are averaged per measurement
+#define RUNS 32
+#define DELAY 2000
+
+ISR(TIMER2_COMPA_vect);
+
+//! Selects the yield variant both processes use
+static volatile bool useLegacy = false;
+//! Number of times the partner process got the CPU
+static volatile uint16_t partnerRuns = 0;
+
+//! Former os_yield: a yield through the whole scheduler interrupt
+static void legacyYield(void) {
+    uint8_t sreg = SREG;
+    cli();
+    os_setProcessState(os_getCurrentProc(), OS_PS_BLOCKED);
+    TIMER2_COMPA_vect();
+    SREG = sreg;
+}
+
+static void benchYield(void) {
+    if (useLegacy) {
+        legacyYield();
+    } else {
+        os_yield();
+    }
+}
+
+//! Starts Timer 1 without prescaler, so TCNT1 counts CPU cycles
+static void startCycleCounter(void) {
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);
+}
+
+//! Average number of cycles of one context switch with the selected variant
+static uint16_t measure(bool legacy) {
+    useLegacy = legacy;
+    // Let the partner pick up the variant
+    benchYield();
+
+    uint16_t before = partnerRuns;
+    uint32_t cycles = 0;
+    for (uint8_t i = 0; i < RUNS; i++) {
+        uint16_t start = TCNT1;
+        benchYield();
+        cycles += (uint16_t)(TCNT1 - start);
+    }
+    if ((uint16_t)(partnerRuns - before) != RUNS) {
+        os_error("Partner missed  a round trip");
+    }
+    // Every round trip consists of two switches
+    return cycles / (2 * RUNS);
+}
+
+PROGRAM(1, AUTOSTART) {
+    startCycleCounter();
+    lcd_writeProgString(PSTR("Yield fast path "));
+    lcd_writeProgString(PSTR("old/new cycles"));
+    delayMs(DELAY);
+
+    while (1) {
+        // Only the two test processes may switch, so stop the scheduler tick
+        uint8_t tccr2b = TCCR2B;
+        TCCR2B &= ~((1 << CS22) | (1 << CS21) | (1 << CS20));
+        uint16_t legacy = measure(true);
+        uint16_t fast = measure(false);
+        TCCR2B = tccr2b;
+
+        lcd_clear();
+        lcd_writeProgString(PSTR("switch "));
+        lcd_writeDec(legacy);
+        lcd_writeChar('/');
+        lcd_writeDec(fast);
+        lcd_line2();
+        lcd_writeProgString(PSTR("TESTS PASSED"));
+        delayMs(DELAY);
+    }
+}
+
+//! Partner that yields back right away
+PROGRAM(2, AUTOSTART) {
+    while (1) {
+        partnerRuns++;
+        benchYield();
+    }
+}
@@ -0,0 +1,173 @@
+//-------------------------------------------------
+//          TestSuite: Protothreads
+// One process hosts a hundred stackless tasks that
+// sleep for different times, a producer and a
+// consumer that wait for each other and a task
+// that spawns another one. Every task has to run
+// as often as expected, sleeps must not end early
+// and a second process has to keep running while
+// all tasks sleep.
+// Copy this file over SPOS/progs.c to run it.
+//-------------------------------------------------
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+#include "os_pt.h"
+#include "os_input.h"
+
+//--------------CONFIG AREA------------------
+
+// Number of sleeping tasks
+#define SLEEPERS (100)
+
+// Number of times every sleeping task sleeps
+#define ROUNDS (5)
+
+// Number of items the producer passes to the consumer
+#define ITEMS (50)
+
+//------------END OF CONFIG------------------
+
+#define DELAY (2000ul)
+
+//! Sleep time of a sleeping task (10 to 50 ms)
+#define SLEEP_MS(I) (10 * ((I) % 5 + 1))
+
+static PtScheduler scheduler = PT_SCHEDULER_INIT;
+
+//! State of a sleeping task, the locals of a task do not survive a wait
+typedef struct {
+    uint8_t index;
+    uint8_t rounds;
+    Time slept;
+} SleeperState;
+
+static PtTask sleepers[SLEEPERS];
+static SleeperState sleeperStates[SLEEPERS];
+static PtTask producer, consumer, parent, child;
+
+//! Item passed from the producer to the consumer (0: none)
+static uint8_t item;
+static uint8_t consumed;
+
+//! Set once the child ran
+static bool childRan;
+
+//! Loops of the second process, which only runs while the host does not
+volatile uint32_t otherLoops;
+
+//! Sleeps ROUNDS times and checks that no sleep ended early
+PtResult sleeper(PtTask* task) {
+    SleeperState* state = task->arg;
+    PT_BEGIN(task);
+    for (state->rounds = 0; state->rounds < ROUNDS; state->rounds++) {
+        state->slept = os_systemTime_raw();
+        PT_SLEEP_MS(task, SLEEP_MS(state->index));
+        if (os_systemTime_raw() - state->slept < TIME_MS_TO_RAW(SLEEP_MS(state->index))) {
+            os_error("Woke up early");
+        }
+    }
+    PT_END(task);
+}
+
+//! Passes ITEMS items to the consumer, one at a time
+PtResult produce(PtTask* task) {
+    static uint8_t next;
+    PT_BEGIN(task);
+    for (next = 1; next <= ITEMS; next++) {
+        PT_WAIT_UNTIL(task, item == 0);
+        item = next;
+    }
+    PT_END(task);
+}
+
+//! Takes the items in order
+PtResult consume(PtTask* task) {
+    PT_BEGIN(task);
+    while (consumed < ITEMS) {
+        PT_WAIT_UNTIL(task, item != 0);
+        if (item != consumed + 1) {
+            os_error("Item out of     order");
+        }
+        consumed = item;
+        item = 0;
+        PT_YIELD(task);
+    }
+    PT_END(task);
+}
+
+PtResult runChild(PtTask* task) {
+    PT_BEGIN(task);
+    childRan = true;
+    PT_END(task);
+}
+
+//! Spawns a child and waits for it
+PtResult spawnChild(PtTask* task) {
+    PT_BEGIN(task);
+    os_ptSpawn(&scheduler, &child, runChild, NULL);
+    PT_WAIT_UNTIL(task, childRan);
+    PT_END(task);
+}
+
+PROGRAM(1, AUTOSTART) {
+    lcd_writeProgString(PSTR("Protothreads"));
+    lcd_line2();
+    lcd_writeDec(sizeof(PtTask));
+    lcd_writeProgString(PSTR(" B per task"));
+    delayMs(DELAY);
+
+    for (uint8_t i = 0; i < SLEEPERS; i++) {
+        sleeperStates[i].index = i;
+        os_ptSpawn(&scheduler, &sleepers[i], sleeper, &sleeperStates[i]);
+    }
+    os_ptSpawn(&scheduler, &producer, produce, NULL);
+    os_ptSpawn(&scheduler, &consumer, consume, NULL);
+    os_ptSpawn(&scheduler, &parent, spawnChild, NULL);
+
+    os_exec(2, DEFAULT_PRIORITY);
+    Time const start = os_systemTime_raw();
+    os_ptRun(&scheduler);
+    Time const elapsed = os_systemTime_raw() - start;
+
+    lcd_clear();
+    lcd_writeProgString(PSTR("Done in "));
+    lcd_writeDec(elapsed * 1000ul / TIME_RAW_PER_S);
+    lcd_writeProgString(PSTR("ms"));
+    lcd_line2();
+    lcd_writeProgString(PSTR("other "));
+    lcd_writeDec(otherLoops);
+    delayMs(DELAY);
+
+    for (uint8_t i = 0; i < SLEEPERS; i++) {
+        if (sleeperStates[i].rounds != ROUNDS) {
+            os_error("Sleeper lost");
+        }
+    }
+    if (consumed != ITEMS || !childRan) {
+        os_error("Task lost");
+    }
+    if (elapsed < TIME_MS_TO_RAW(ROUNDS * SLEEP_MS(4))) {
+        os_error("Too fast");
+    }
+    if (!otherLoops) {
+        os_error("Host hogged CPU");
+    }
+
+    // SUCCESS
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    lcd_line2();
+    lcd_writeProgString(PSTR(" PLEASE CONFIRM!"));
+    os_waitForInput();
+    os_waitForNoInput();
+}
+
+//! Counts while the host does not need the CPU
+PROGRAM(2, DONTSTART) {
+    while (1) {
+        otherLoops++;
+    }
+}
@@ -0,0 +1,132 @@
+//-------------------------------------------------
+//          TestSuite: Worker Pool
+// Runs far more jobs than there are process slots
+// on a pool of three workers and checks that every
+// job ran exactly once. Then the workers are kept
+// busy, so the queue fills up: os_trySubmit has to
+// fail instead of losing the job, and everything
+// has to run once the workers are free again.
+// Copy this file over SPOS/progs.c to run it.
+//-------------------------------------------------
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+#include "os_workpool.h"
+#include "os_input.h"
+
+//--------------CONFIG AREA------------------
+
+// Number of worker processes
+#define WORKERS (3)
+
+// Number of jobs of the first test
+#define JOBS (200)
+
+// Number of jobs submitted before they are awaited
+#define BATCH (10)
+
+//------------END OF CONFIG------------------
+
+#define DELAY (2000ul)
+
+WORKPOOL_WORKER(2)
+
+static Job jobs[WORKPOOL_QUEUE_SIZE + WORKERS];
+
+//! Bit per job of the first test, set by the job
+static uint8_t ran[(JOBS + 7) / 8];
+
+//! Workers wait for it in the second test
+static Semaphore gate = SEMAPHORE_INIT(0);
+
+//! Marks the job with the passed number as run
+void markRan(void* arg) {
+    uint16_t const n = (uint16_t)arg;
+    if (ran[n / 8] & (1 << (n % 8))) {
+        os_error("Job ran twice");
+    }
+    ran[n / 8] |= 1 << (n % 8);
+}
+
+//! Keeps a worker busy until the gate opens
+void waitAtGate(void* arg) {
+    os_semWait(&gate);
+}
+
+PROGRAM(1, AUTOSTART) {
+    lcd_writeProgString(PSTR("Worker pool"));
+    delayMs(DELAY);
+
+    if (os_workpoolStart(2, WORKERS, DEFAULT_PRIORITY) != WORKERS) {
+        os_error("Workers missing");
+    }
+
+    // 1. Many more jobs than process slots
+    Time const start = os_systemTime_raw();
+    for (uint16_t n = 0; n < JOBS; n += BATCH) {
+        for (uint8_t i = 0; i < BATCH; i++) {
+            os_submit(&jobs[i], markRan, (void*)(n + i));
+        }
+        for (uint8_t i = 0; i < BATCH; i++) {
+            os_await(&jobs[i]);
+            if (!jobs[i].done) {
+                os_error("Not done");
+            }
+        }
+    }
+    Time const elapsed = os_systemTime_raw() - start;
+    for (uint16_t n = 0; n < JOBS; n++) {
+        if (!(ran[n / 8] & (1 << (n % 8)))) {
+            os_error("Job lost");
+        }
+    }
+    lcd_clear();
+    lcd_writeDec(JOBS);
+    lcd_writeProgString(PSTR(" jobs"));
+    lcd_line2();
+    lcd_writeDec(elapsed * 1000ul / TIME_RAW_PER_S);
+    lcd_writeProgString(PSTR("ms"));
+    delayMs(DELAY);
+
+    // 2. Back-pressure: busy workers and a full queue
+    uint16_t const rejected = os_getWorkpoolRejected();
+    for (uint8_t i = 0; i < WORKERS; i++) {
+        os_submit(&jobs[i], waitAtGate, NULL);
+    }
+    while (os_getWorkpoolPending()) {
+        os_yield();
+    }
+    for (uint8_t i = WORKERS; i < WORKERS + WORKPOOL_QUEUE_SIZE; i++) {
+        if (!os_trySubmit(&jobs[i], waitAtGate, NULL)) {
+            os_error("Queue too small");
+        }
+    }
+    Job extra;
+    if (os_trySubmit(&extra, waitAtGate, NULL) || os_getWorkpoolRejected() != rejected + 1) {
+        os_error("Overload missed");
+    }
+    if (os_getWorkpoolPending() != WORKPOOL_QUEUE_SIZE) {
+        os_error("Wrong pending");
+    }
+
+    uint16_t const completed = os_getWorkpoolCompleted();
+    for (uint8_t i = 0; i < WORKERS + WORKPOOL_QUEUE_SIZE; i++) {
+        os_semSignal(&gate);
+    }
+    for (uint8_t i = 0; i < WORKERS + WORKPOOL_QUEUE_SIZE; i++) {
+        os_await(&jobs[i]);
+    }
+    if (os_getWorkpoolCompleted() != completed + WORKERS + WORKPOOL_QUEUE_SIZE) {
+        os_error("Job lost");
+    }
+
+    // SUCCESS
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    lcd_line2();
+    lcd_writeProgString(PSTR(" PLEASE CONFIRM!"));
+    os_waitForInput();
+    os_waitForNoInput();
+}
@@ -0,0 +1,135 @@
+//-------------------------------------------------
+//          TestSuite: Kernel Latency
+// Runs a workload of yields, LCD output, heap use
+// and short interrupt-free sections and checks the
+// statistics of the Timer 1 measurement mode: all
+// kernel paths have to be sampled, the histograms
+// have to add up and the scheduler interrupt has
+// to stay below a bound. The results are shown and
+// can be compared with the Kernel Latency page of
+// the task manager.
+// Needs OS_MEASURE set to 1 in defines.h.
+// Copy this file over SPOS/progs.c to run it.
+//-------------------------------------------------
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+#include "os_memory.h"
+#include "os_memheap_drivers.h"
+#include "os_measure.h"
+#include "os_input.h"
+
+#if !OS_MEASURE
+#error "Set OS_MEASURE to 1 in defines.h to run this test"
+#endif
+
+//--------------CONFIG AREA------------------
+
+// How long the workload runs (in ms)
+#define MEASURE_MS (3000ul)
+
+// Maximum accepted duration of the scheduler interrupt (in us)
+#define MAX_TICK_US (300)
+
+// Size of the chunks allocated by the workload
+#define CHUNK (16)
+
+//------------END OF CONFIG------------------
+
+#define DELAY (2000ul)
+
+//! Set while the workload should keep running
+volatile bool busy;
+
+//! Counts the rounds of the interrupt-free sections
+volatile uint16_t counter;
+
+//! Checks and shows the statistics of a kernel path
+void check(MeasureCategory category, char const* name) {
+    MeasureStats const* const stats = os_getMeasureStats(category);
+    lcd_clear();
+    lcd_writeProgString(name);
+    lcd_writeChar(' ');
+    lcd_writeDec(stats->count);
+    lcd_line2();
+    lcd_writeDec(MEASURE_TICKS_TO_US(stats->min));
+    lcd_writeChar('/');
+    lcd_writeDec(stats->count ? MEASURE_TICKS_TO_US(stats->sum / stats->count) : 0);
+    lcd_writeChar('/');
+    lcd_writeDec(MEASURE_TICKS_TO_US(stats->max));
+    lcd_writeProgString(PSTR("us"));
+    delayMs(DELAY);
+
+    if (!stats->count) {
+        os_error("No samples");
+    }
+    if (stats->min > stats->max || stats->sum / stats->count < stats->min || stats->sum / stats->count > stats->max) {
+        os_error("Min/avg/max");
+    }
+    if (stats->count != UINT16_MAX) {
+        uint16_t sum = 0;
+        for (uint8_t i = 0; i < MEASURE_BUCKETS; i++) {
+            sum += stats->buckets[i];
+        }
+        if (sum != stats->count) {
+            os_error("Histogram");
+        }
+    }
+}
+
+PROGRAM(1, AUTOSTART) {
+    lcd_writeProgString(PSTR("Kernel latency"));
+    delayMs(DELAY);
+
+    busy = true;
+    os_exec(2, DEFAULT_PRIORITY);
+    os_exec(3, DEFAULT_PRIORITY);
+    os_measureReset();
+    os_sleepMs(MEASURE_MS);
+    busy = false;
+
+    check(OS_MC_TICK, PSTR("Tick"));
+    check(OS_MC_SWITCH, PSTR("Switch"));
+    check(OS_MC_DISPATCH, PSTR("Dispatch"));
+    check(OS_MC_PREEMPT_OFF, PSTR("Preempt off"));
+    check(OS_MC_IRQ_OFF, PSTR("IRQ off"));
+
+    if (MEASURE_TICKS_TO_US(os_getMeasureStats(OS_MC_TICK)->max) > MAX_TICK_US) {
+        os_error("Tick too slow");
+    }
+
+    // SUCCESS
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    lcd_line2();
+    lcd_writeProgString(PSTR(" PLEASE CONFIRM!"));
+    os_waitForInput();
+    os_waitForNoInput();
+}
+
+//! Writes to the LCD and uses the external heap (critical sections)
+PROGRAM(2, DONTSTART) {
+    uint8_t i = 0;
+    while (busy) {
+        lcd_goto(2, 13);
+        lcd_writeDec(i++ % 10);
+        MemAddr const chunk = os_malloc(extHeap, CHUNK);
+        if (!chunk) {
+            os_error("Out of memory");
+        }
+        os_free(extHeap, chunk);
+        os_yield();
+    }
+}
+
+//! Short sections with interrupts disabled and voluntary switches
+PROGRAM(3, DONTSTART) {
+    while (busy) {
+        uint8_t const sreg = os_irqSave();
+        counter++;
+        os_irqRestore(sreg);
+        os_yield();
+    }
+}
@@ -0,0 +1,105 @@
+//-------------------------------------------------
+//          TestSuite: Stack Integrity
+//-------------------------------------------------
+// Reports the cycles of one context switch for every stack
+// integrity mode, once with a shallow and once with a deep stack
+// of the measuring process. Two processes hand the CPU back and
+// forth with os_yield while the scheduler tick is stopped.
+// Copy this file over SPOS/progs.c to run it.
+
+#include <avr/interrupt.h>
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+
+// Number of round trips that are averaged per measurement
+#define RUNS 32
+#define DELAY 2000
+// Recursion depth and bytes per level for the deep stack
+#define DEEP 8
+#define PAD 8
+
+//! Number of times the partner process got the CPU
+static volatile uint16_t partnerRuns = 0;
+
+//! Starts Timer 1 without prescaler, so TCNT1 counts CPU cycles
+static void startCycleCounter(void) {
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);
+}
+
+//! Average number of cycles of one context switch, measured depth calls deep
+static uint16_t measureAtDepth(uint8_t depth) {
+    volatile uint8_t pad[PAD];
+    pad[0] = depth;
+    if (depth > 0) {
+        // Use pad after the call, so the frame can not be dropped
+        return measureAtDepth(depth - 1) + pad[0] - depth;
+    }
+
+    uint16_t before = partnerRuns;
+    uint32_t cycles = 0;
+    for (uint8_t i = 0; i < RUNS; i++) {
+        uint16_t start = TCNT1;
+        os_yield();
+        cycles += (uint16_t)(TCNT1 - start);
+    }
+    if ((uint16_t)(partnerRuns - before) != RUNS) {
+        os_error("Partner missed  a round trip");
+    }
+    // Every round trip consists of two switches
+    return cycles / (2 * RUNS);
+}
+
+static void printMode(char const* name, StackIntegrityMode mode) {
+    os_setStackIntegrityMode(mode);
+    // Let both stacks get sealed once in the new mode
+    os_yield();
+    uint16_t shallow = measureAtDepth(0);
+    uint16_t deep = measureAtDepth(DEEP);
+
+    lcd_writeProgString(name);
+    lcd_writeDec(shallow);
+    lcd_writeChar('/');
+    lcd_writeDec(deep);
+    lcd_writeProgString(PSTR("   "));
+}
+
+PROGRAM(1, AUTOSTART) {
+    startCycleCounter();
+    lcd_writeProgString(PSTR("Stack integrity "));
+    lcd_writeProgString(PSTR("shallow/deep"));
+    delayMs(DELAY);
+
+    StackIntegrityMode initial = os_getStackIntegrityMode();
+    while (1) {
+        // Only the two test processes may switch, so stop the scheduler tick
+        uint8_t tccr2b = TCCR2B;
+        TCCR2B &= ~((1 << CS22) | (1 << CS21) | (1 << CS20));
+        lcd_clear();
+        printMode(PSTR("off "), OS_SI_OFF);
+        lcd_line2();
+        printMode(PSTR("chk "), OS_SI_CHECKSUM);
+        TCCR2B = tccr2b;
+        delayMs(DELAY);
+
+        TCCR2B &= ~((1 << CS22) | (1 << CS21) | (1 << CS20));
+        lcd_clear();
+        printMode(PSTR("can "), OS_SI_CANARY);
+        lcd_line2();
+        printMode(PSTR("smp "), OS_SI_SAMPLED);
+        os_setStackIntegrityMode(initial);
+        TCCR2B = tccr2b;
+        delayMs(DELAY);
+    }
+}
+
+//! Partner that yields back right away
+PROGRAM(2, AUTOSTART) {
+    while (1) {
+        partnerRuns++;
+        os_yield();
+    }
+}
@@ -0,0 +1,124 @@
+//-------------------------------------------------
+//          TestSuite: Stack Sizes
+//-------------------------------------------------
+// Starts programs with different stack sizes until no process
+// slot or stack room is left, checks that no two stacks overlap,
+// reuses the gap of a killed process and shows the high-water marks.
+// Copy this file over SPOS/progs.c to run it.
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+
+#define DELAY 1500
+#define SMALL 64
+#define LARGE 300
+
+//! Uses about depth * 16 bytes of stack
+static uint8_t burn(uint8_t depth) {
+    volatile uint8_t pad[16];
+    pad[0] = depth;
+    if (depth == 0) {
+        return 0;
+    }
+    return burn(depth - 1) + pad[0] - depth;
+}
+
+static bool stacksOverlap(ProcessID a, ProcessID b) {
+    Process const* pa = os_getProcessSlot(a);
+    Process const* pb = os_getProcessSlot(b);
+    uint16_t limitA = pa->stackBottom - pa->stackSize + 1;
+    uint16_t limitB = pb->stackBottom - pb->stackSize + 1;
+    return limitA <= pb->stackBottom && limitB <= pa->stackBottom;
+}
+
+static void checkStacks(void) {
+    for (ProcessID a = 0; a < MAX_NUMBER_OF_PROCESSES; a++) {
+        Process const* pa = os_getProcessSlot(a);
+        if (pa->state == OS_PS_UNUSED) {
+            continue;
+        }
+        if (pa->stackBottom > BOTTOM_OF_PROCS_STACK || pa->stackBottom - pa->stackSize + 1 < STACK_REGION_LIMIT) {
+            os_error("Stack outside  of region");
+        }
+        for (ProcessID b = a + 1; b < MAX_NUMBER_OF_PROCESSES; b++) {
+            if (os_getProcessSlot(b)->state != OS_PS_UNUSED && stacksOverlap(a, b)) {
+                os_error("Stacks overlap");
+            }
+        }
+    }
+}
+
+PROGRAM(1, AUTOSTART) {
+    lcd_writeProgString(PSTR("Stack sizes"));
+    delayMs(DELAY);
+
+    if (os_getProgramStackSize(2) != SMALL || os_getProgramStackSize(3) != LARGE
+            || os_getProgramStackSize(1) != STACK_SIZE_PROC) {
+        os_error("Wrong program  stack size");
+    }
+
+    // Alternate small and large stacks until no slot or room is left
+    uint8_t started = 0;
+    ProgramID prog = 3;
+    while (os_exec(prog, DEFAULT_PRIORITY) != INVALID_PROCESS) {
+        started++;
+        checkStacks();
+        prog = (prog == 3) ? 2 : 3;
+    }
+    lcd_clear();
+    lcd_writeDec(started);
+    lcd_writeProgString(PSTR(" started"));
+    delayMs(DELAY);
+
+    // Kill a large one and refill the gap with small ones
+    for (ProcessID pid = MAX_NUMBER_OF_PROCESSES - 1; pid > 0; pid--) {
+        if (os_getProcessSlot(pid)->progID == 3) {
+            os_kill(pid);
+            break;
+        }
+    }
+    while (os_exec(2, DEFAULT_PRIORITY) != INVALID_PROCESS) {
+        checkStacks();
+    }
+
+    // Let the workers reach their deepest point
+    delayMs(DELAY);
+    for (ProcessID pid = 0; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        Process const* proc = os_getProcessSlot(pid);
+        if (proc->state == OS_PS_UNUSED) {
+            continue;
+        }
+        uint16_t used = os_getStackHighWater(pid);
+        if (used == 0 || used > proc->stackSize) {
+            os_error("Bad high-water mark");
+        }
+        lcd_clear();
+        lcd_writeChar('#');
+        lcd_writeDec(pid);
+        lcd_writeProgString(PSTR(" used "));
+        lcd_writeDec(used);
+        lcd_writeChar('/');
+        lcd_writeDec(proc->stackSize);
+        delayMs(DELAY);
+    }
+
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    while (1) {}
+}
+
+//! Worker with a small stack
+PROGRAM_EX(2, DONTSTART, SMALL, DEFAULT_PRIORITY) {
+    while (1) {
+        burn(0);
+    }
+}
+
+//! Worker with a large stack that actually uses a part of it
+PROGRAM_EX(3, DONTSTART, LARGE, DEFAULT_PRIORITY) {
+    while (1) {
+        burn(8);
+    }
+}
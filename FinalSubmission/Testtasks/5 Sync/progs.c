@@ -0,0 +1,120 @@
+//-------------------------------------------------
+//          TestSuite: Sync
+//-------------------------------------------------
+// Checks semaphores and mutexes of os_sync:
+// 1. A producer and a consumer exchange items through a bounded
+//    buffer guarded by two counting semaphores.
+// 2. Three processes increment a shared counter under a mutex.
+// 3. A process that holds a mutex is killed, the waiter must
+//    get the mutex.
+// Copy this file over SPOS/progs.c to run it.
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+#include "os_sync.h"
+
+#define DELAY 1000
+#define BUFFER_SIZE 4
+#define ITEMS 200
+#define INCREMENTS 500
+
+static Semaphore freeSlots = SEMAPHORE_INIT(BUFFER_SIZE);
+static Semaphore usedSlots = SEMAPHORE_INIT(0);
+static uint8_t buffer[BUFFER_SIZE];
+static Semaphore consumerDone = SEMAPHORE_INIT(0);
+
+static Mutex counterLock = MUTEX_INIT;
+static volatile uint16_t counter = 0;
+static Semaphore incrementerDone = SEMAPHORE_INIT(0);
+
+static Mutex victimLock = MUTEX_INIT;
+static volatile bool victimHasLock = false;
+
+//! Producer
+PROGRAM(2, DONTSTART) {
+    for (uint16_t i = 0; i < ITEMS; i++) {
+        os_semWait(&freeSlots);
+        buffer[i % BUFFER_SIZE] = (uint8_t)i;
+        os_semSignal(&usedSlots);
+    }
+}
+
+//! Consumer
+PROGRAM(3, DONTSTART) {
+    for (uint16_t i = 0; i < ITEMS; i++) {
+        os_semWait(&usedSlots);
+        if (buffer[i % BUFFER_SIZE] != (uint8_t)i) {
+            os_error("Item out of     order");
+        }
+        os_semSignal(&freeSlots);
+    }
+    os_semSignal(&consumerDone);
+}
+
+//! Incrementer, the read-modify-write is stretched to provoke preemption
+PROGRAM(4, DONTSTART) {
+    for (uint16_t i = 0; i < INCREMENTS; i++) {
+        os_mutexLock(&counterLock);
+        uint16_t value = counter;
+        for (volatile uint8_t j = 0; j < 50; j++) {}
+        counter = value + 1;
+        os_mutexUnlock(&counterLock);
+    }
+    os_semSignal(&incrementerDone);
+}
+
+//! Takes the victim lock and never gives it back
+PROGRAM(5, DONTSTART) {
+    os_mutexLock(&victimLock);
+    victimHasLock = true;
+    while (1) {}
+}
+
+PROGRAM(1, AUTOSTART) {
+    lcd_writeProgString(PSTR("1: Semaphores"));
+    os_exec(3, DEFAULT_PRIORITY);
+    os_exec(2, DEFAULT_PRIORITY);
+    os_semWait(&consumerDone);
+    if (freeSlots.count != BUFFER_SIZE || usedSlots.count != 0) {
+        os_error("Semaphores not  balanced");
+    }
+    lcd_writeProgString(PSTR(" OK"));
+    delayMs(DELAY);
+
+    lcd_clear();
+    lcd_writeProgString(PSTR("2: Mutex"));
+    for (uint8_t i = 0; i < 3; i++) {
+        os_exec(4, DEFAULT_PRIORITY);
+    }
+    for (uint8_t i = 0; i < 3; i++) {
+        os_semWait(&incrementerDone);
+    }
+    if (counter != 3 * INCREMENTS) {
+        os_error("Lost update");
+    }
+    lcd_writeProgString(PSTR(" OK"));
+    delayMs(DELAY);
+
+    lcd_clear();
+    lcd_writeProgString(PSTR("3: Kill owner"));
+    ProcessID victim = os_exec(5, DEFAULT_PRIORITY);
+    while (!victimHasLock) {
+        os_yield();
+    }
+    if (os_mutexTryLock(&victimLock)) {
+        os_error("Mutex not held");
+    }
+    os_kill(victim);
+    if (!os_mutexTryLock(&victimLock)) {
+        os_error("Mutex not       released on kill");
+    }
+    os_mutexUnlock(&victimLock);
+    lcd_writeProgString(PSTR(" OK"));
+    delayMs(DELAY);
+
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    while (1) {}
+}
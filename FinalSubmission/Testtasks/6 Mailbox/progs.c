@@ -0,0 +1,109 @@
+//-------------------------------------------------
+//          TestSuite: Mailbox
+//-------------------------------------------------
+// A three-stage pipeline: the producer sends numbered messages
+// through a mailbox on the internal heap to a filter, which
+// doubles the value and passes them on through a mailbox on the
+// external heap to the main process. Order and content of every
+// message are checked and the throughput is shown.
+// Afterwards the non-blocking variants are tested on an empty and
+// on a full mailbox.
+// Copy this file over SPOS/progs.c to run it.
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+#include "os_memheap_drivers.h"
+#include "os_mailbox.h"
+
+#define DELAY 2000
+#define MESSAGES 1000
+#define CAPACITY 8
+
+typedef struct {
+    uint16_t seq;
+    uint16_t value;
+} Message;
+
+static Mailbox toFilter;
+static Mailbox toMain;
+
+//! Producer
+PROGRAM(2, DONTSTART) {
+    Message msg;
+    for (uint16_t i = 0; i < MESSAGES; i++) {
+        msg.seq = i;
+        msg.value = i + 7;
+        os_mboxSend(&toFilter, &msg);
+    }
+}
+
+//! Filter
+PROGRAM(3, DONTSTART) {
+    Message msg;
+    for (uint16_t i = 0; i < MESSAGES; i++) {
+        os_mboxReceive(&toFilter, &msg);
+        msg.value *= 2;
+        os_mboxSend(&toMain, &msg);
+    }
+}
+
+static void testNonBlocking(void) {
+    Mailbox box;
+    if (!os_mboxCreate(&box, intHeap, sizeof(Message), 2)) {
+        os_error("Could not create mailbox");
+    }
+    Message msg = { 1, 2 };
+    if (os_mboxTryReceive(&box, &msg)) {
+        os_error("Received from  empty mailbox");
+    }
+    if (!os_mboxTrySend(&box, &msg) || !os_mboxTrySend(&box, &msg)) {
+        os_error("Could not send");
+    }
+    if (os_mboxTrySend(&box, &msg) || os_mboxCount(&box) != 2) {
+        os_error("Sent to full   mailbox");
+    }
+    Message got;
+    if (!os_mboxTryReceive(&box, &got) || got.seq != 1 || got.value != 2) {
+        os_error("Wrong message");
+    }
+    os_mboxDestroy(&box);
+}
+
+PROGRAM(1, AUTOSTART) {
+    lcd_writeProgString(PSTR("Mailbox pipeline"));
+    if (!os_mboxCreate(&toFilter, intHeap, sizeof(Message), CAPACITY)
+            || !os_mboxCreate(&toMain, extHeap, sizeof(Message), CAPACITY)) {
+        os_error("Could not create mailbox");
+    }
+
+    Time start = os_systemTime_precise();
+    os_exec(3, DEFAULT_PRIORITY);
+    os_exec(2, DEFAULT_PRIORITY);
+    Message msg;
+    for (uint16_t i = 0; i < MESSAGES; i++) {
+        os_mboxReceive(&toMain, &msg);
+        if (msg.seq != i || msg.value != 2 * (i + 7)) {
+            os_error("Wrong message");
+        }
+    }
+    Time duration = os_systemTime_precise() - start;
+
+    lcd_clear();
+    lcd_writeDec(MESSAGES);
+    lcd_writeProgString(PSTR(" msgs in"));
+    lcd_line2();
+    lcd_writeDec(duration);
+    lcd_writeProgString(PSTR(" ms"));
+    delayMs(DELAY);
+
+    os_mboxDestroy(&toFilter);
+    os_mboxDestroy(&toMain);
+
+    testNonBlocking();
+
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    while (1) {}
+}
@@ -0,0 +1,100 @@
+//-------------------------------------------------
+//          TestSuite: EDF
+//-------------------------------------------------
+// Runs periodic processes under OS_SS_EDF next to a background
+// process that never gives up the CPU.
+// 1. Two periodic tasks with a total utilization of 0.4 must not
+//    miss a single deadline and must finish the expected number
+//    of jobs.
+// 2. A third task overloads the CPU, misses have to be counted.
+// The statistics can also be checked on the "Periodic Tasks"
+// page of the task manager.
+// Copy this file over SPOS/progs.c to run it.
+
+#include <util/delay.h>
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+
+#define RUNTIME 5000
+#define DELAY 2000
+
+//! Periodic: 20 ms of work every 100 ms
+PROGRAM(2, DONTSTART) {
+    _delay_ms(20);
+}
+
+//! Periodic: 10 ms of work every 50 ms, deadline 40 ms
+PROGRAM(3, DONTSTART) {
+    _delay_ms(10);
+}
+
+//! Periodic: 25 ms of work every 30 ms (overload)
+PROGRAM(4, DONTSTART) {
+    _delay_ms(25);
+}
+
+//! Background load without deadline
+PROGRAM(5, DONTSTART) {
+    while (1) {}
+}
+
+static void printInfo(ProcessID pid) {
+    PeriodicInfo const* info = os_getPeriodicInfo(pid);
+    lcd_writeChar('#');
+    lcd_writeDec(pid);
+    lcd_writeProgString(PSTR(" X"));
+    lcd_writeDec(info->misses);
+    lcd_writeChar('/');
+    lcd_writeDec(info->jobs);
+    lcd_writeProgString(PSTR("     "));
+}
+
+PROGRAM(1, AUTOSTART) {
+    lcd_writeProgString(PSTR("1: EDF U=0.4"));
+    os_setSchedulingStrategy(OS_SS_EDF);
+    os_exec(5, DEFAULT_PRIORITY);
+    ProcessID a = os_execPeriodic(2, 100, 100);
+    ProcessID b = os_execPeriodic(3, 50, 40);
+    if (a == INVALID_PROCESS || b == INVALID_PROCESS) {
+        os_error("Could not exec  periodic");
+    }
+    // The main process has no deadline either, so sleep instead of busy waiting
+    os_sleepMs(RUNTIME);
+
+    lcd_clear();
+    printInfo(a);
+    lcd_line2();
+    printInfo(b);
+    PeriodicInfo const* infoA = os_getPeriodicInfo(a);
+    PeriodicInfo const* infoB = os_getPeriodicInfo(b);
+    if (infoA->misses != 0 || infoB->misses != 0) {
+        os_error("Deadline missed");
+    }
+    if (infoA->jobs < RUNTIME / 100 - 1 || infoB->jobs < RUNTIME / 50 - 1) {
+        os_error("Jobs missing");
+    }
+    os_sleepMs(DELAY);
+
+    lcd_clear();
+    lcd_writeProgString(PSTR("2: Overload"));
+    ProcessID c = os_execPeriodic(4, 30, 30);
+    os_sleepMs(RUNTIME);
+    lcd_clear();
+    printInfo(c);
+    lcd_line2();
+    printInfo(b);
+    if (os_getPeriodicInfo(a)->misses + os_getPeriodicInfo(b)->misses + os_getPeriodicInfo(c)->misses == 0) {
+        os_error("Misses not      counted");
+    }
+    os_sleepMs(DELAY);
+    os_kill(c);
+    os_kill(b);
+    os_kill(a);
+
+    lcd_clear();
+    lcd_writeProgString(PSTR("ALL TESTS PASSED"));
+    while (1) {}
+}
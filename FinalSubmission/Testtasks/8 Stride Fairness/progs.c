@@ -0,0 +1,179 @@
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_scheduler.h"
+#include <avr/interrupt.h>
+
+//--------------CONFIG AREA------------------
+
+//define strategies to test
+
+#define STRIDE (1)      // OS_SS_STRIDE
+#define RR     (1)      // OS_SS_ROUND_ROBIN
+#define RAND   (1)      // OS_SS_RANDOM
+#define EVEN   (1)      // OS_SS_EVEN
+
+//------------ADVANCED CONFIG----------------
+
+// Priorities (= tickets for OS_SS_STRIDE) of the three workers
+#define TICKETS_A (32)
+#define TICKETS_B (64)
+#define TICKETS_C (128)
+
+// How long the workers compete per strategy (in ms)
+#define MEASURE_MS (10000ul)
+
+// Allowed deviation of a share from the ticket ratio (in percentage points)
+// Only strategies with CHECKED set are required to stay inside.
+#define TOLERANCE (3)
+
+//------------END OF CONFIG------------------
+
+
+//              WARNING
+// YOU SHOULD NOT NEED TO CHANGE ANYTHING BEYOND THIS POINT
+
+//---------Defines/Const/Typedefs------------
+#define DELAY (2000ul)
+#define WORKERS 3
+#define STRATEGYCOUNT (sizeof(results) / sizeof(results[0]))
+
+static char PROGMEM const strideStr[] = "STRIDE";
+static char PROGMEM const     rrStr[] = "ROUND ROBIN";
+static char PROGMEM const   randStr[] = "RAND";
+static char PROGMEM const   evenStr[] = "EVEN";
+
+typedef struct TestResults{
+    uint8_t share[WORKERS];
+    char const* const name;
+    SchedulingStrategy strat;
+    uint8_t active;
+    uint8_t checked;
+} TestResults;
+
+typedef unsigned long volatile Iterations;
+
+//------------Runtime variables---------------
+Iterations iterations[WORKERS];
+ProcessID  workers[WORKERS];
+Priority const tickets[WORKERS] = { TICKETS_A, TICKETS_B, TICKETS_C };
+
+TestResults results[4] = {
+    {{0},strideStr ,OS_SS_STRIDE       ,STRIDE ,1},
+    {{0},rrStr     ,OS_SS_ROUND_ROBIN  ,RR     ,0},
+    {{0},randStr   ,OS_SS_RANDOM       ,RAND   ,0},
+    {{0},evenStr   ,OS_SS_EVEN         ,EVEN   ,0},
+};
+
+//------------Internal functions---------------
+
+//! Share of worker i (in percent) a strategy should achieve with the configured tickets
+uint8_t expectedShare(uint8_t i) {
+    unsigned long total = (unsigned long)TICKETS_A + TICKETS_B + TICKETS_C;
+    return (100ul * tickets[i] + total / 2) / total;
+}
+
+//! Counts loop iterations as a measure of CPU time
+void loop(Iterations* count) {
+    while (1) {
+        ++*count;
+    }
+}
+
+//! Lets the workers compete under the strategy and stores their shares
+void performTest(TestResults* result) {
+    os_setSchedulingStrategy(result->strat);
+    for (uint8_t i = 0; i < WORKERS; i++) {
+        iterations[i] = 0;
+    }
+    workers[0] = os_exec(2, TICKETS_A);
+    workers[1] = os_exec(3, TICKETS_B);
+    workers[2] = os_exec(4, TICKETS_C);
+
+    // The main process must not take a share itself
+    os_sleepMs(MEASURE_MS);
+
+    os_enterCriticalSection();
+    unsigned long counts[WORKERS];
+    unsigned long total = 0;
+    for (uint8_t i = 0; i < WORKERS; i++) {
+        counts[i] = iterations[i];
+        total += counts[i];
+    }
+    os_leaveCriticalSection();
+
+    for (uint8_t i = 0; i < WORKERS; i++) {
+        os_kill(workers[i]);
+        result->share[i] = total ? (100ul * counts[i] + total / 2) / total : 0;
+    }
+}
+
+//! true if all shares are within TOLERANCE of the ticket ratio
+bool sharesFit(TestResults const* result) {
+    for (uint8_t i = 0; i < WORKERS; i++) {
+        int16_t diff = (int16_t)result->share[i] - expectedShare(i);
+        if (diff > TOLERANCE || diff < -TOLERANCE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void showResult(TestResults const* result) {
+    lcd_clear();
+    lcd_writeProgString(result->name);
+    lcd_line2();
+    for (uint8_t i = 0; i < WORKERS; i++) {
+        lcd_writeDec(result->share[i]);
+        lcd_writeProgString(i != WORKERS - 1 ? PSTR("|") : PSTR("%"));
+    }
+    if (result->checked) {
+        lcd_writeProgString(sharesFit(result) ? PSTR(" OK") : PSTR(" BAD"));
+    }
+}
+
+//------------Programs---------------
+
+//! Main test program.
+PROGRAM(1, AUTOSTART) {
+    lcd_writeProgString(PSTR("Shares expected:"));
+    for (uint8_t i = 0; i < WORKERS; i++) {
+        lcd_writeDec(expectedShare(i));
+        lcd_writeProgString(i != WORKERS - 1 ? PSTR("|") : PSTR("%"));
+    }
+    delayMs(DELAY);
+
+    bool failed = false;
+    for (uint8_t s = 0; s < STRATEGYCOUNT; s++) {
+        if (!results[s].active) {
+            continue;
+        }
+        lcd_clear();
+        lcd_writeProgString(PSTR("Testing "));
+        lcd_line2();
+        lcd_writeProgString(results[s].name);
+        performTest(&results[s]);
+        showResult(&results[s]);
+        failed |= results[s].checked && !sharesFit(&results[s]);
+        delayMs(DELAY);
+    }
+
+    lcd_clear();
+    lcd_writeProgString(failed ? PSTR("-----FAILED-----") : PSTR("----SUCCESS-----"));
+    while (1) {}
+}
+
+//! Worker A
+PROGRAM(2, DONTSTART) {
+    loop(&iterations[0]);
+}
+
+//! Worker B
+PROGRAM(3, DONTSTART) {
+    loop(&iterations[1]);
+}
+
+//! Worker C
+PROGRAM(4, DONTSTART) {
+    loop(&iterations[2]);
+}